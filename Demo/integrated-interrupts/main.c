@@ -36,18 +36,10 @@ static volatile uint32_t * const SENSOR_FILTER_REG_ADDR = (uint32_t * const)0x50
 
 static const unsigned mainDELAY_LOOP_COUNT = 10000;
 
-SemaphoreHandle_t sem;
-
-
-BaseType_t sensor_irq_handler() {    
-    BaseType_t pxHigherPriorityTaskWoken = pdFALSE;
-    BaseType_t ans = xSemaphoreGiveFromISR(sem, &pxHigherPriorityTaskWoken);
-    
-    // Note: use *portRETURN_FROM_ISR* to return to the task that was interrupted, and use *portYIELD_FROM_ISR* to trigger a scheduler context switch (if necessary) in order to immediately return to the woken task
-    
-	//portRETURN_FROM_ISR;
-	portYIELD_FROM_ISR( pxHigherPriorityTaskWoken );
-}
+// The sensor source is bound to this notification bit of the dump task, so
+// no C handler runs for it, see vIRQBindToTaskNotify.
+#define SENSOR_IRQ          2
+#define SENSOR_NOTIFY_BIT   ( 1UL << 0 )
 
 void vTaskSomething(void *pvParameters) {
     volatile uint32_t ul;
@@ -62,8 +54,9 @@ void vTaskSomething(void *pvParameters) {
 void vTaskDumpSensorData(void *pvParameters) {
     const TickType_t xDelay100ms = pdMS_TO_TICKS( 100 );
     for (int k=0; k<5; ++k) {  //NOTE: terminating loop only for demonstration
-        BaseType_t ans = xSemaphoreTake(sem, xDelay100ms);
-        if (ans == pdFALSE) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, SENSOR_NOTIFY_BIT, &bits, xDelay100ms);
+        if ((bits & SENSOR_NOTIFY_BIT) == 0) {
             printf("Dump Task sensor data not available @%d\n", xTaskGetTickCount());
         } else {
             printf("Dump Task Running @%d\n", xTaskGetTickCount());
@@ -77,16 +70,16 @@ void vTaskDumpSensorData(void *pvParameters) {
 }
 
 int main() {
-	register_interrupt_handler(2, sensor_irq_handler);
+	TaskHandle_t dump_task;
+
+	xTaskCreate( vTaskSomething, "Task 1", 1000, NULL, 1, NULL );
+	xTaskCreate( vTaskDumpSensorData, "Task 2", 1000, NULL, 2, &dump_task );
+
+	vIRQBindToTaskNotify(SENSOR_IRQ, dump_task, SENSOR_NOTIFY_BIT);
+	set_interrupt_priority(SENSOR_IRQ, 1);
 	
 	*SENSOR_SCALER_REG_ADDR = 10;
 	*SENSOR_FILTER_REG_ADDR = 2;
-	
-	sem = xSemaphoreCreateBinary();
-	configASSERT( sem != NULL );
-	
-	xTaskCreate( vTaskSomething, "Task 1", 1000, NULL, 1, NULL );
-	xTaskCreate( vTaskDumpSensorData, "Task 2", 1000, NULL, 2, NULL );
 
     vTaskStartScheduler();
 		
@@ -0,0 +1,190 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* RISCV includes */
+#include "arch/syscalls.h"
+#include "arch/clib.h"
+#include "arch/irq.h"
+#include "arch/encoding.h"
+
+/*
+ * FreeRTOS hook for when malloc fails, enable in FreeRTOSConfig.
+ */
+void vApplicationMallocFailedHook( void );
+
+/*
+ * FreeRTOS hook for when freertos is idling, enable in FreeRTOSConfig.
+ */
+void vApplicationIdleHook( void );
+
+/*
+ * FreeRTOS hook for when a stackoverflow occurs, enable in FreeRTOSConfig.
+ */
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The sensor raises its interrupt with a fixed period, so the spread between
+ * the shortest and the longest interval seen by the handler is the variation
+ * of the interrupt latency.  A low priority task keeps the kernel busy in long
+ * critical sections.  The benchmark runs twice: once with the sensor at a
+ * priority the kernel masks, and once above configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * where critical sections no longer delay it.  Two more rounds wake a task
+ * from the interrupt, once from a handler and once through a notification
+ * binding.  The Makefile sets configUSE_IRQ_LATENCY_STATS, so every round
+ * also prints the dispatch and wake latencies measured by the port.
+ */
+
+static volatile uint32_t * const SENSOR_SCALER_REG_ADDR = (uint32_t * const)0x50000080;
+static volatile uint32_t * const SENSOR_FILTER_REG_ADDR = (uint32_t * const)0x50000084;
+
+#define SENSOR_IRQ                  2
+#define CRITICAL_SECTION_LOOP_COUNT 20000
+#define MEASUREMENT_TIME            pdMS_TO_TICKS( 2000 )
+
+static volatile unsigned long last_arrival;
+static volatile unsigned long min_interval;
+static volatile unsigned long max_interval;
+static volatile unsigned long num_samples;
+
+static volatile unsigned long num_wakes;
+static TaskHandle_t waiter;
+
+BaseType_t sensor_irq_handler( void *context );
+BaseType_t sensor_wake_handler( void *context );
+void vTaskCriticalLoad( void *pvParameters );
+void vTaskWaiter( void *pvParameters );
+void vTaskBenchmark( void *pvParameters );
+
+
+/* Runs above configMAX_SYSCALL_INTERRUPT_PRIORITY in the second round, so it
+must not call the FreeRTOS API. */
+BaseType_t sensor_irq_handler( void *context ) {
+    unsigned long now = read_csr(mcycle);
+    unsigned long interval = now - last_arrival;
+    ( void ) context;
+
+    if (num_samples > 0) {
+        if (interval < min_interval)
+            min_interval = interval;
+        if (interval > max_interval)
+            max_interval = interval;
+    }
+    last_arrival = now;
+    num_samples++;
+
+    portRETURN_FROM_ISR;
+}
+
+BaseType_t sensor_wake_handler( void *context ) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)context, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+void vTaskWaiter( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        num_wakes++;
+    }
+}
+
+void vTaskCriticalLoad( void *pvParameters ) {
+    volatile uint32_t ul;
+    ( void ) pvParameters;
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        for (ul = 0; ul < CRITICAL_SECTION_LOOP_COUNT; ul++)
+            ;
+        taskEXIT_CRITICAL();
+    }
+}
+
+static void run_round( const char *name, uint32_t priority ) {
+    /* priority 0 disables the source while the results are reset and read */
+    set_interrupt_priority(SENSOR_IRQ, 0);
+    num_samples = 0;
+    num_wakes = 0;
+    min_interval = ~0UL;
+    max_interval = 0;
+    reset_interrupt_latency();
+    set_interrupt_priority(SENSOR_IRQ, priority);
+
+    vTaskDelay(MEASUREMENT_TIME);
+
+    set_interrupt_priority(SENSOR_IRQ, 0);
+    if (num_samples > 0)
+        printf("%s (priority %u): %lu samples, interval min %lu max %lu, jitter %lu cycles\n",
+               name, (unsigned)priority, num_samples, min_interval, max_interval,
+               max_interval - min_interval);
+    else
+        printf("%s (priority %u): %lu wakes\n", name, (unsigned)priority, num_wakes);
+    print_interrupt_latency();
+}
+
+void vTaskBenchmark( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    run_round("masked by the kernel", configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    run_round("above the kernel", configMAX_SYSCALL_INTERRUPT_PRIORITY + 1);
+
+    register_interrupt_handler(SENSOR_IRQ, sensor_wake_handler, waiter, 0);
+    run_round("task woken by a handler", configMAX_SYSCALL_INTERRUPT_PRIORITY);
+
+    vIRQBindToTaskNotify(SENSOR_IRQ, waiter, 1);
+    run_round("task notified by binding", configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    vIRQBindToTaskNotify(SENSOR_IRQ, NULL, 0);
+
+    exit(0);
+}
+
+int main( void ) {
+    register_interrupt_handler(SENSOR_IRQ, sensor_irq_handler, NULL, 0);
+
+    *SENSOR_SCALER_REG_ADDR = 2;
+    *SENSOR_FILTER_REG_ADDR = 2;
+
+    xTaskCreate( vTaskCriticalLoad, "Load", 1000, NULL, 1, NULL );
+    xTaskCreate( vTaskBenchmark, "Benchmark", 1000, NULL, 2, NULL );
+    xTaskCreate( vTaskWaiter, "Waiter", 1000, NULL, 3, &waiter );
+
+    vTaskStartScheduler();
+
+    configASSERT( 0 );
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	/* vApplicationMallocFailedHook() will only be called if
+	configUSE_MALLOC_FAILED_HOOK is set to 1 in FreeRTOSConfig.h.  It is a hook
+	function that will get called if a call to pvPortMalloc() fails. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* vApplicationIdleHook() will only be called if configUSE_IDLE_HOOK is set
+	to 1 in FreeRTOSConfig.h. */
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
+{
+	( void ) pcTaskName;
+	( void ) pxTask;
+
+	/* Run time stack overflow checking is performed if
+	configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
+	function is called if a stack overflow is detected. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
@@ -84,8 +84,11 @@
  * See http://www.freertos.org/a00110.html.
  *----------------------------------------------------------*/
 
-#include <stdint.h>
-extern uint32_t SystemCoreClock;
+/* The assembly files of the port include this file as well. */
+#ifndef __ASSEMBLER__
+	#include <stdint.h>
+	extern uint32_t SystemCoreClock;
+#endif
 
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				0
@@ -95,7 +98,6 @@ extern uint32_t SystemCoreClock;
 #define configTICK_RATE_HZ			( 1000 )
 #define configMAX_PRIORITIES		( 5 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 1024 )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 1024 * 1024 ) )
 #define configMAX_TASK_NAME_LEN			( 16 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -109,6 +111,9 @@ extern uint32_t SystemCoreClock;
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configGENERATE_RUN_TIME_STATS	0
 
+/* Give every task its own newlib state, see arch/newlib.c. */
+#define configUSE_NEWLIB_REENTRANT		1
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 			0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
@@ -84,8 +84,11 @@
  * See http://www.freertos.org/a00110.html.
  *----------------------------------------------------------*/
 
-#include <stdint.h>
-extern uint32_t SystemCoreClock;
+/* The assembly files of the port include this file as well. */
+#ifndef __ASSEMBLER__
+	#include <stdint.h>
+	extern uint32_t SystemCoreClock;
+#endif
 
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				0
@@ -95,7 +98,6 @@ extern uint32_t SystemCoreClock;
 #define configTICK_RATE_HZ			( 700 )
 #define configMAX_PRIORITIES		( 5 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 3*1024 )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 1024 * 1024 ) )		//See link.ld
 #define configMAX_TASK_NAME_LEN			( 16 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
@@ -109,6 +111,9 @@ extern uint32_t SystemCoreClock;
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configGENERATE_RUN_TIME_STATS	0
 
+/* Give every task its own newlib state, see arch/newlib.c. */
+#define configUSE_NEWLIB_REENTRANT		1
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 			0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
@@ -119,6 +124,13 @@ extern uint32_t SystemCoreClock;
 #define configTIMER_QUEUE_LENGTH		2
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE )
 
+/* Deferred interrupt work queue, used by the network driver.  The driver
+only submits to lane 0, and its handler gets the stack of the task it
+replaced. */
+#define configUSE_WORK_QUEUES			1
+#define configWORK_QUEUE_LANES			1
+#define configWORK_QUEUE_TASK_STACK_DEPTH	1000
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 #define INCLUDE_vTaskPrioritySet		1
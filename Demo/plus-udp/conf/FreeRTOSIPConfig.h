@@ -158,6 +158,11 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigETHERNET_DRIVER_CHECKS_UDP_CHECKSUM 0
 #endif
 
+/* Checksums are calculated by arch/memops.c, with the vector unit if the
+target has one. */
+#include "memops.h"
+#define ipconfigGENERATE_CHECKSUM( pucData, usLength ) ip_checksum( ( pucData ), ( usLength ) )
+
 static volatile uint32_t * const ETHERNET_STATUS_REG_ADDR       = (uint32_t * const)0x30000000;
 static volatile uint32_t * const ETHERNET_RECEIVE_SIZE_REG_ADDR = ETHERNET_STATUS_REG_ADDR       + 1;
 static volatile uint32_t * const ETHERNET_RECEIVE_DST_REG_ADDR  = ETHERNET_RECEIVE_SIZE_REG_ADDR + 1;
@@ -0,0 +1,168 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* RISCV includes */
+#include "arch/syscalls.h"
+#include "arch/clib.h"
+#include "arch/irq.h"
+
+/*
+ * FreeRTOS hook for when malloc fails, enable in FreeRTOSConfig.
+ */
+void vApplicationMallocFailedHook( void );
+
+/*
+ * FreeRTOS hook for when freertos is idling, enable in FreeRTOSConfig.
+ */
+void vApplicationIdleHook( void );
+
+/*
+ * FreeRTOS hook for when a stackoverflow occurs, enable in FreeRTOSConfig.
+ */
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Prints the cycles, instructions and instructions per cycle of every task,
+ * of the tick interrupt and of the sensor interrupt once a second.  The
+ * cycles spent in the interrupt handlers are not part of the task numbers.
+ * The Makefile sets configUSE_BOOT_PROFILE, so the statistics task, which has
+ * the highest priority and runs first, prints the boot phases when it starts.
+ */
+
+static volatile char * const SENSOR_INPUT_ADDR = (char * const)0x50000000;
+static volatile uint32_t * const SENSOR_SCALER_REG_ADDR = (uint32_t * const)0x50000080;
+static volatile uint32_t * const SENSOR_FILTER_REG_ADDR = (uint32_t * const)0x50000084;
+
+#define SENSOR_IRQ          2
+#define MAX_TASKS           8
+#define NUM_REPORTS         3
+#define BUSY_LOOP_COUNT     5000
+
+static SemaphoreHandle_t sem;
+static volatile uint32_t sensor_sum;
+
+BaseType_t sensor_irq_handler( void *context );
+void vTaskSensor( void *pvParameters );
+void vTaskBusy( void *pvParameters );
+void vTaskStats( void *pvParameters );
+
+
+BaseType_t sensor_irq_handler( void *context ) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t)context, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+void vTaskSensor( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    for (;;) {
+        xSemaphoreTake(sem, portMAX_DELAY);
+        for (int i = 0; i < 64; ++i)
+            sensor_sum += *(SENSOR_INPUT_ADDR + i);
+    }
+}
+
+void vTaskBusy( void *pvParameters ) {
+    volatile uint32_t ul;
+    ( void ) pvParameters;
+
+    for (;;) {
+        for (ul = 0; ul < BUSY_LOOP_COUNT; ul++)
+            ;
+        vTaskDelay(1);
+    }
+}
+
+/* Instructions per cycle with two decimals. */
+static void print_counters( const char *name, uint64_t cycles, uint64_t instructions ) {
+    unsigned long long ipc = cycles ? (instructions * 100) / cycles : 0;
+    printf("%-12s %14llu %14llu %4llu.%02llu\n", name,
+           (unsigned long long)cycles, (unsigned long long)instructions,
+           ipc / 100, ipc % 100);
+}
+
+void vTaskStats( void *pvParameters ) {
+    static TaskStatus_t status[MAX_TASKS];
+    PortISRStats_t isr;
+    irq_counters_t counters;
+    UBaseType_t num_tasks;
+    ( void ) pvParameters;
+
+    vSyscallBootReport();
+
+    for (int k = 0; k < NUM_REPORTS; ++k) {
+        vTaskDelay(pdMS_TO_TICKS( 1000 ));
+
+        num_tasks = uxTaskGetSystemState(status, MAX_TASKS, NULL);
+        printf("%-12s %14s %14s %7s\n", "", "cycles", "instructions", "IPC");
+        for (UBaseType_t i = 0; i < num_tasks; ++i)
+            print_counters(status[i].pcTaskName, status[i].ulRunTimeCounter,
+                           status[i].ulRunTimeInstructionCounter);
+
+        vPortGetTickISRStats(&isr);
+        print_counters("tick irq", isr.ullCycles, isr.ullInstructions);
+        get_interrupt_stats(SENSOR_IRQ, &isr);
+        print_counters("sensor irq", isr.ullCycles, isr.ullInstructions);
+
+        get_interrupt_counters(SENSOR_IRQ, &counters);
+        printf("sensor irq: %lu runs, max %lu cycles, %lu spurious claims\n",
+               (unsigned long)counters.count, (unsigned long)counters.max_cycles,
+               (unsigned long)counters.spurious);
+    }
+
+    exit(0);
+}
+
+int main( void ) {
+    sem = xSemaphoreCreateBinary();
+    configASSERT( sem != NULL );
+
+    register_interrupt_handler(SENSOR_IRQ, sensor_irq_handler, sem, 1);
+
+    *SENSOR_SCALER_REG_ADDR = 10;
+    *SENSOR_FILTER_REG_ADDR = 2;
+
+    xTaskCreate( vTaskBusy, "Busy", 1000, NULL, 1, NULL );
+    xTaskCreate( vTaskSensor, "Sensor", 1000, NULL, 2, NULL );
+    xTaskCreate( vTaskStats, "Stats", 1000, NULL, 3, NULL );
+
+    vTaskStartScheduler();
+
+    configASSERT( 0 );
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	/* vApplicationMallocFailedHook() will only be called if
+	configUSE_MALLOC_FAILED_HOOK is set to 1 in FreeRTOSConfig.h.  It is a hook
+	function that will get called if a call to pvPortMalloc() fails. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* vApplicationIdleHook() will only be called if configUSE_IDLE_HOOK is set
+	to 1 in FreeRTOSConfig.h. */
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
+{
+	( void ) pcTaskName;
+	( void ) pxTask;
+
+	/* Run time stack overflow checking is performed if
+	configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
+	function is called if a stack overflow is detected. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,118 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* RISCV includes */
+#include "arch/syscalls.h"
+#include "arch/clib.h"
+
+/*
+ * FreeRTOS hook for when malloc fails, enable in FreeRTOSConfig.
+ */
+void vApplicationMallocFailedHook( void );
+
+/*
+ * FreeRTOS hook for when freertos is idling, enable in FreeRTOSConfig.
+ */
+void vApplicationIdleHook( void );
+
+/*
+ * FreeRTOS hook for when a stackoverflow occurs, enable in FreeRTOSConfig.
+ */
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * A fixed amount of work is split over NUM_WORKERS tasks of equal priority.
+ * With a second hart the work should finish in about half the ticks.  One
+ * worker is pinned to hart 1 to show the affinity API.  Only the benchmark
+ * task prints, the workers just count.
+ */
+
+#define NUM_WORKERS         4
+#define WORK_PER_WORKER     2000000UL
+
+static volatile unsigned long work_done[NUM_WORKERS];
+static volatile unsigned long workers_running;
+
+void vTaskWorker( void *pvParameters );
+void vTaskBenchmark( void *pvParameters );
+
+
+void vTaskWorker( void *pvParameters ) {
+    volatile unsigned long *counter = pvParameters;
+
+    while (*counter < WORK_PER_WORKER)
+        (*counter)++;
+
+    taskENTER_CRITICAL();
+    workers_running--;
+    taskEXIT_CRITICAL();
+
+    vTaskDelete(NULL);
+}
+
+void vTaskBenchmark( void *pvParameters ) {
+    TaskHandle_t worker;
+    TickType_t start;
+    unsigned i;
+    ( void ) pvParameters;
+
+    workers_running = NUM_WORKERS;
+    start = xTaskGetTickCount();
+
+    for (i = 0; i < NUM_WORKERS; i++) {
+        xTaskCreate( vTaskWorker, "Worker", 1000, (void *)&work_done[i], 1, &worker );
+        if (i == 0)
+            vTaskCoreAffinitySet( worker, ( 1 << 1 ) );
+    }
+
+    while (workers_running > 0)
+        vTaskDelay(1);
+
+    printf("%u workers on %u harts: %lu ticks\n", NUM_WORKERS,
+           (unsigned)configNUMBER_OF_CORES,
+           (unsigned long)(xTaskGetTickCount() - start));
+
+    exit(0);
+}
+
+int main( void ) {
+    xTaskCreate( vTaskBenchmark, "Benchmark", 1000, NULL, 2, NULL );
+
+    vTaskStartScheduler();
+
+    configASSERT( 0 );
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	/* vApplicationMallocFailedHook() will only be called if
+	configUSE_MALLOC_FAILED_HOOK is set to 1 in FreeRTOSConfig.h.  It is a hook
+	function that will get called if a call to pvPortMalloc() fails. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* vApplicationIdleHook() will only be called if configUSE_IDLE_HOOK is set
+	to 1 in FreeRTOSConfig.h. */
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
+{
+	( void ) pcTaskName;
+	( void ) pxTask;
+
+	/* Run time stack overflow checking is performed if
+	configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
+	function is called if a stack overflow is detected. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
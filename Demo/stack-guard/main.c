@@ -0,0 +1,97 @@
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* RISCV includes */
+#include "arch/syscalls.h"
+#include "arch/clib.h"
+
+/*
+ * Shows the PMP stack guard of the port, see configENABLE_PMP_STACK_GUARD in
+ * portcontext.h.  The Makefile enables it and FreeRTOSConfig.h turns
+ * configCHECK_FOR_STACK_OVERFLOW off, so the context switches check nothing.
+ * The Deep task goes one call deeper every round until it runs into the guard
+ * at the end of its stack.  The access faults, reports the overflow through
+ * vApplicationStackOverflowHook and ends the program with the fault cause as
+ * exit code.  The Tick task keeps printing next to it to show that the other
+ * tasks are not hurt until then.
+ */
+
+#define DEEP_STACK_SIZE     256
+#define CALL_WORDS          16
+
+void vTaskDeep( void *pvParameters );
+void vTaskTick( void *pvParameters );
+void vApplicationMallocFailedHook( void );
+void vApplicationIdleHook( void );
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName );
+
+static uint32_t recurse( uint32_t depth ) {
+    volatile uint32_t frame[ CALL_WORDS ];
+
+    frame[ 0 ] = depth;
+    if( depth == 0 )
+        return frame[ 0 ];
+    return recurse( depth - 1 ) + frame[ 0 ];
+}
+
+void vTaskDeep( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    for( uint32_t depth = 1;; ++depth ) {
+        printf( "deep: %u calls of %u bytes\n", ( unsigned ) depth,
+                ( unsigned ) sizeof( uint32_t[ CALL_WORDS ] ) );
+        recurse( depth );
+        vTaskDelay( pdMS_TO_TICKS( 5 ) );
+    }
+}
+
+void vTaskTick( void *pvParameters ) {
+    ( void ) pvParameters;
+
+    for( ;; ) {
+        printf( "tick: %u\n", ( unsigned ) xTaskGetTickCount() );
+        vTaskDelay( pdMS_TO_TICKS( 20 ) );
+    }
+}
+
+int main( void ) {
+    xTaskCreate( vTaskDeep, "Deep", DEEP_STACK_SIZE, NULL, 2, NULL );
+    xTaskCreate( vTaskTick, "Tick", configMINIMAL_STACK_SIZE, NULL, 1, NULL );
+
+    vTaskStartScheduler();
+
+    configASSERT( 0 );
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	/* vApplicationMallocFailedHook() will only be called if
+	configUSE_MALLOC_FAILED_HOOK is set to 1 in FreeRTOSConfig.h.  It is a hook
+	function that will get called if a call to pvPortMalloc() fails. */
+	taskDISABLE_INTERRUPTS();
+	for( ;; );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* vApplicationIdleHook() will only be called if configUSE_IDLE_HOOK is set
+	to 1 in FreeRTOSConfig.h. */
+}
+/*-----------------------------------------------------------*/
+
+/* Called by the port from the access fault on the interrupt stack, so only
+the name is recorded here.  On return the fault ends the program, see
+ulSyscallTrap. */
+volatile const char *pcOverflowedTask;
+
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
+{
+	( void ) pxTask;
+
+	pcOverflowedTask = pcTaskName;
+}
+/*-----------------------------------------------------------*/
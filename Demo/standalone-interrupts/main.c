@@ -34,7 +34,8 @@ static volatile uint32_t * const SENSOR_FILTER_REG_ADDR = (uint32_t * const)0x50
 
 _Bool has_sensor_data = 0;
 
-BaseType_t sensor_irq_handler() {
+BaseType_t sensor_irq_handler(void *context) {
+	(void)context;
 	has_sensor_data = 1;
 	portRETURN_FROM_ISR;
 }
@@ -52,7 +53,7 @@ void dump_sensor_data() {
 }
 
 int main() {
-	register_interrupt_handler(2, sensor_irq_handler);
+	register_interrupt_handler(2, sensor_irq_handler, NULL, 1);
 	
 	*SENSOR_SCALER_REG_ADDR = 5;
 	*SENSOR_FILTER_REG_ADDR = 2;
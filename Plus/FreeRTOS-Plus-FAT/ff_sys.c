@@ -147,6 +147,7 @@ int FF_FS_Add( const char *pcPath, FF_Disk_t *pxDisk )
 		else
 		{
 			vTaskSuspendAll();
+			taskENTER_CRITICAL_SMP();
 			{
 				if( index < 0 )
 				{
@@ -157,6 +158,7 @@ int FF_FS_Add( const char *pcPath, FF_Disk_t *pxDisk )
 				file_systems.systems[ index ].xPathlen = len;
 				file_systems.systems[ index ].pxManager = pxDisk->pxIOManager;
 			}
+			taskEXIT_CRITICAL_SMP();
 			xTaskResumeAll( );
 			ret = 1;
 		}
@@ -678,6 +678,7 @@ xFreeRTOS_Socket_t *pxSocket;
 		}
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* Check to ensure the port is not already in use. */
 			if( pxListFindListItemWithValue( &xBoundSocketsList, ( TickType_t ) pxAddress->sin_port ) != NULL )
@@ -685,6 +686,7 @@ xFreeRTOS_Socket_t *pxSocket;
 				xReturn = FREERTOS_EADDRINUSE;
 			}
 		}
+		taskEXIT_CRITICAL_SMP();
 		xTaskResumeAll();
 
 		/* Check that xReturn has not been set before continuing. */
@@ -849,11 +851,13 @@ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     //printf("Starting xProcessReceivedUDPPacket with port %u\n", usPort);
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		/* See if there is a list item associated with the port number on the
 		list of bound sockets. */
 		pxListItem = pxListFindListItemWithValue( &xBoundSocketsList, ( TickType_t ) usPort );
 	}
+	taskEXIT_CRITICAL_SMP();
 	xTaskResumeAll();
 
 	if( pxListItem != NULL )
@@ -864,6 +868,7 @@ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 		pxSocket = ( xFreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxListItem );
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 			{
@@ -901,6 +906,7 @@ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 				//printf("Semaphore Given xProcessReceivedUDPPacket\n");
 			}
 		}
+		taskEXIT_CRITICAL_SMP();
 		if( xTaskResumeAll() == pdFALSE )
 		{
 			if( xHigherPriorityTaskWoken != pdFALSE )
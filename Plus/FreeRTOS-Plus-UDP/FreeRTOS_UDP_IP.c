@@ -1734,6 +1734,28 @@ uint16_t usLength, usReturn;
 #endif /* ( ipconfigREPLY_TO_INCOMING_PINGS == 1 ) || ( ipconfigSUPPORT_OUTGOING_PINGS == 1 ) */
 /*-----------------------------------------------------------*/
 
+#ifdef ipconfigGENERATE_CHECKSUM
+
+static uint16_t prvGenerateChecksum( const uint8_t * const pucNextData, const uint16_t usDataLengthBytes, BaseType_t xChecksumIsOffloaded )
+{
+uint16_t usReturn;
+
+	if( xChecksumIsOffloaded == pdFALSE )
+	{
+		/* The application provides an optimised implementation, which has to
+		return the same value as the generic implementation below. */
+		usReturn = ( uint16_t ) ipconfigGENERATE_CHECKSUM( pucNextData, usDataLengthBytes );
+	}
+	else
+	{
+		usReturn = 0;
+	}
+
+	return usReturn;
+}
+
+#else
+
 static uint16_t prvGenerateChecksum( const uint8_t * const pucNextData, const uint16_t usDataLengthBytes, BaseType_t xChecksumIsOffloaded )
 {
 uint32_t ulChecksum = 0;
@@ -1782,6 +1804,8 @@ uint16_t us, usDataLength16BitWords, *pusNextData, usReturn;
 
 	return usReturn;
 }
+
+#endif /* ipconfigGENERATE_CHECKSUM */
 /*-----------------------------------------------------------*/
 
 static void prvReturnEthernetFrame( xNetworkBufferDescriptor_t * const pxNetworkBuffer )
@@ -153,4 +153,9 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigETHERNET_DRIVER_CHECKS_UDP_CHECKSUM 0
 #endif
 
+/* ipconfigGENERATE_CHECKSUM( pucData, usLength ) can be defined to replace the
+generic loop that calculates the IP, UDP and ICMP checksums.  It has to return
+the inverted one's complement sum of the 16-bit words, in the byte order the
+words are stored in. */
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
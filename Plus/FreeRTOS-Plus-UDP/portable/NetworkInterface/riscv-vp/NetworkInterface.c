@@ -8,6 +8,7 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "workqueue.h"
 
 /* FreeRTOS+UDP includes. */
 #include "FreeRTOS_UDP_IP.h"
@@ -69,113 +70,105 @@ BaseType_t IsDataAvailable()
 /*-----------------------------------------------------------*/
 // FreeRTOS interface
 
-SemaphoreHandle_t xEMACRxEventSemaphore;
+/* Received frames are processed by the work queue rather than by a task of
+the driver.  The work item is the context of the interrupt handler. */
+static WorkItem_t xEMACRxWork;
 
 
-BaseType_t ethernet_mac_irq_handler( void ) {
+static BaseType_t ethernet_mac_irq_handler( void *context ) {
     BaseType_t pxHigherPriorityTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(xEMACRxEventSemaphore, &pxHigherPriorityTaskWoken);
+    xWorkQueueSubmitFromISR(( WorkItem_t * ) context, &pxHigherPriorityTaskWoken);
 
 	//portRETURN_FROM_ISR;
 	portYIELD_FROM_ISR( pxHigherPriorityTaskWoken );
 }
 
 
-/* The deferred interrupt handler is a standard RTOS task. */
-static void prvEMACDeferredInterruptHandlerTask( void *pvParameters )
+/* The deferred interrupt handler runs in a work queue worker.  Interrupts
+that arrive before it runs are coalesced into one submission, so it takes all
+frames the MAC holds. */
+static void prvEMACDeferredInterruptHandler( void *pvParameters )
 {
     xNetworkBufferDescriptor_t *pxNetworkBuffer;
     size_t xBytesReceived;
     extern QueueHandle_t xNetworkEventQueue;
     xIPStackEvent_t xRxEvent;
     (void) pvParameters;
-    for( ;; )
+
+    /* See how much data was received.  Here it is assumed ReceiveSize() is
+    a peripheral driver function that returns the number of bytes in the
+    received Ethernet frame, or 0 once all frames have been taken. */
+    while( ( xBytesReceived = ReceiveSize() ) > 0 )
     {
-        //printf("NetworkInterface Wait\n");
-        
-        /* Wait for the Ethernet MAC interrupt to indicate that another packet
-        has been received.  It is assumed xEMACRxEventSemaphore is a counting
-        semaphore (to count the Rx events) and that the semaphore has already
-        been created. */
-        xSemaphoreTake( xEMACRxEventSemaphore, portMAX_DELAY );
-        
-        //printf("NetworkInterface Ready to Receive\n");
-
-        /* See how much data was received.  Here it is assumed ReceiveSize() is
-        a peripheral driver function that returns the number of bytes in the
-        received Ethernet frame. */
-        xBytesReceived = ReceiveSize();
-
-        if( xBytesReceived > 0 )
-        {
-            /* Allocate a network buffer descriptor that references an Ethernet
-            buffer large enough to hold the received data. */
-            pxNetworkBuffer = pxNetworkBufferGet( xBytesReceived, 0 );
+        /* Allocate a network buffer descriptor that references an Ethernet
+        buffer large enough to hold the received data. */
+        pxNetworkBuffer = pxNetworkBufferGet( xBytesReceived, 0 );
 
-            if( pxNetworkBuffer != NULL )
+        if( pxNetworkBuffer != NULL )
+        {
+            /* pxNetworkBuffer->pucEthernetBuffer now points to an Ethernet
+            buffer large enough to hold the received data.  Copy the
+            received data into pcNetworkBuffer->pucEthernetBuffer.  Here it
+            is assumed ReceiveData() is a peripheral driver function that
+            copies the received data into a buffer passed in as the function's
+            parameter. */
+            ReceiveData( pxNetworkBuffer->pucEthernetBuffer );
+            
+            //printf("Receive Finished\n");
+
+            /* See if the data contained in the received Ethernet frame needs
+            to be processed. */
+            if( eConsiderFrameForProcessing( pxNetworkBuffer->pucEthernetBuffer )
+                                                                  == eProcessBuffer )
             {
-                /* pxNetworkBuffer->pucEthernetBuffer now points to an Ethernet
-                buffer large enough to hold the received data.  Copy the
-                received data into pcNetworkBuffer->pucEthernetBuffer.  Here it
-                is assumed ReceiveData() is a peripheral driver function that
-                copies the received data into a buffer passed in as the function's
-                parameter. */
-                ReceiveData( pxNetworkBuffer->pucEthernetBuffer );
+                //printf("Consider Frame For Processing\n");
                 
-                //printf("Receive Finished\n");
+                /* The event about to be sent to the IP stack is an Rx event. */
+                xRxEvent.eEventType = eEthernetRxEvent;
+
+                /* pvData is used to point to the network buffer descriptor that
+                references the received data. */
+                xRxEvent.pvData = ( void * ) pxNetworkBuffer;
 
-                /* See if the data contained in the received Ethernet frame needs
-                to be processed. */
-                if( eConsiderFrameForProcessing( pxNetworkBuffer->pucEthernetBuffer )
-                                                                      == eProcessBuffer )
+                /* Send the data to the IP stack. */
+                if( xQueueSendToBack( xNetworkEventQueue, &xRxEvent, 0 ) == pdFALSE )
                 {
-                    //printf("Consider Frame For Processing\n");
+                    //printf("Message Rejected\n");
                     
-                    /* The event about to be sent to the IP stack is an Rx event. */
-                    xRxEvent.eEventType = eEthernetRxEvent;
-
-                    /* pvData is used to point to the network buffer descriptor that
-                    references the received data. */
-                    xRxEvent.pvData = ( void * ) pxNetworkBuffer;
-
-                    /* Send the data to the IP stack. */
-                    if( xQueueSendToBack( xNetworkEventQueue, &xRxEvent, 0 ) == pdFALSE )
-                    {
-                        //printf("Message Rejected\n");
-                        
-                        /* The buffer could not be sent to the IP task so the buffer
-                        must be released. */
-                        vNetworkBufferRelease( pxNetworkBuffer );
-
-                        /* Make a call to the standard trace macro to log the
-                        occurrence. */
-                        iptraceETHERNET_RX_EVENT_LOST();
-                    }
-                    else
-                    {
-                        //printf("Message Accepted\n");
-                        
-                        /* The message was successfully sent to the IP stack.  Call
-                        the standard trace macro to log the occurrence. */
-                        iptraceNETWORK_INTERFACE_RECEIVE();
-                    }
+                    /* The buffer could not be sent to the IP task so the buffer
+                    must be released. */
+                    vNetworkBufferRelease( pxNetworkBuffer );
+
+                    /* Make a call to the standard trace macro to log the
+                    occurrence. */
+                    iptraceETHERNET_RX_EVENT_LOST();
                 }
                 else
                 {
-                    //printf("Drop Frame\n");
+                    //printf("Message Accepted\n");
                     
-                    /* The Ethernet frame can be dropped, but the Ethernet buffer
-                    must be released. */
-                    vNetworkBufferRelease( pxNetworkBuffer );
+                    /* The message was successfully sent to the IP stack.  Call
+                    the standard trace macro to log the occurrence. */
+                    iptraceNETWORK_INTERFACE_RECEIVE();
                 }
             }
             else
             {
-                /* The event was lost because a network buffer was not available.
-                Call the standard trace macro to log the occurrence. */
-                iptraceETHERNET_RX_EVENT_LOST();
+                //printf("Drop Frame\n");
+                
+                /* The Ethernet frame can be dropped, but the Ethernet buffer
+                must be released. */
+                vNetworkBufferRelease( pxNetworkBuffer );
             }
         }
+        else
+        {
+            /* The event was lost because a network buffer was not available.
+            Call the standard trace macro to log the occurrence.  The frame
+            stays in the MAC until the next interrupt. */
+            iptraceETHERNET_RX_EVENT_LOST();
+            break;
+        }
     }
 }
 
@@ -206,14 +199,12 @@ BaseType_t xNetworkInterfaceOutput( xNetworkBufferDescriptor_t * const pxNetwork
 
 
 BaseType_t xNetworkInterfaceInitialise( void ) {
-    xEMACRxEventSemaphore = xSemaphoreCreateCounting(16, 0);
-
-    register_interrupt_handler(7, ethernet_mac_irq_handler);
-    xTaskCreate( prvEMACDeferredInterruptHandlerTask, "prvEMACDeferredInterruptHandlerTask", 1000, NULL, 3, NULL );
+    vWorkItemInit( &xEMACRxWork, prvEMACDeferredInterruptHandler, NULL, 0 );
+    register_interrupt_handler(7, ethernet_mac_irq_handler, &xEMACRxWork, 1);
     
-    if(IsDataAvailable() && uxSemaphoreGetCount(xEMACRxEventSemaphore) == 0)
-    {	//this is safe because we have actually just one element in Semaphore
-    	xSemaphoreGive(xEMACRxEventSemaphore);
+    if(IsDataAvailable())
+    {	//a frame that arrived before the handler was installed
+    	xWorkQueueSubmit( &xEMACRxWork );
     }
 
     return pdPASS;
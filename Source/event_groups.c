@@ -189,6 +189,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		uxOriginalBitValue = pxEventBits->uxEventBits;
 
@@ -231,6 +232,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			}
 		}
 	}
+	taskEXIT_CRITICAL_SMP();
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -312,6 +314,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		const EventBits_t uxCurrentEventBits = pxEventBits->uxEventBits;
 
@@ -379,6 +382,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor );
 		}
 	}
+	taskEXIT_CRITICAL_SMP();
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -518,6 +522,7 @@ BaseType_t xMatchFound = pdFALSE;
 	pxList = &( pxEventBits->xTasksWaitingForBits );
 	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
@@ -589,6 +594,7 @@ BaseType_t xMatchFound = pdFALSE;
 		bit was set in the control word. */
 		pxEventBits->uxEventBits &= ~uxBitsToClear;
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 
 	return pxEventBits->uxEventBits;
@@ -601,6 +607,7 @@ EventGroup_t *pxEventBits = ( EventGroup_t * ) xEventGroup;
 const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		traceEVENT_GROUP_DELETE( xEventGroup );
 
@@ -633,6 +640,7 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 		}
 		#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 }
 /*-----------------------------------------------------------*/
@@ -254,6 +254,37 @@ extern "C" {
 
 #endif /* configUSE_TIMERS */
 
+#ifndef configUSE_WORK_QUEUES
+	#define configUSE_WORK_QUEUES 0
+#endif
+
+#if configUSE_WORK_QUEUES == 1
+
+	#ifndef configWORK_QUEUE_LANES
+		#define configWORK_QUEUE_LANES 2
+	#endif
+
+	#ifndef configWORK_QUEUE_TASK_PRIORITY
+		#define configWORK_QUEUE_TASK_PRIORITY ( configMAX_PRIORITIES - 1 )
+	#endif
+
+	/* A fixed size, as the workers only run the short deferred handlers of the
+	drivers and every lane gets a stack of its own. */
+	#ifndef configWORK_QUEUE_TASK_STACK_DEPTH
+		#define configWORK_QUEUE_TASK_STACK_DEPTH 512
+	#endif
+
+	/* Each lane runs one priority below the previous one. */
+	#if ( configWORK_QUEUE_LANES < 1 ) || ( configWORK_QUEUE_LANES > 10 )
+		#error configWORK_QUEUE_LANES must be between 1 and 10
+	#endif
+
+	#if configWORK_QUEUE_TASK_PRIORITY < configWORK_QUEUE_LANES
+		#error configWORK_QUEUE_TASK_PRIORITY must be at least configWORK_QUEUE_LANES so the workers run above the idle task
+	#endif
+
+#endif /* configUSE_WORK_QUEUES */
+
 #ifndef portSET_INTERRUPT_MASK_FROM_ISR
 	#define portSET_INTERRUPT_MASK_FROM_ISR() 0
 #endif
@@ -274,6 +305,15 @@ extern "C" {
 	#define portSETUP_TCB( pxTCB ) ( void ) pxTCB
 #endif
 
+/* Places the scheduler core in fast memory on ports that have it. */
+#ifndef portFAST_CODE
+	#define portFAST_CODE
+#endif
+
+#ifndef portFAST_DATA
+	#define portFAST_DATA
+#endif
+
 #ifndef configQUEUE_REGISTRY_SIZE
 	#define configQUEUE_REGISTRY_SIZE 0U
 #endif
@@ -710,6 +750,12 @@ extern "C" {
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
 
+#ifndef configRUN_TIME_COUNTER_TYPE
+	/* The type of the run time counters.  A port with a wide cycle counter can
+	set it to uint64_t so the counters do not wrap. */
+	#define configRUN_TIME_COUNTER_TYPE uint32_t
+#endif
+
 #ifndef configUSE_MALLOC_FAILED_HOOK
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
@@ -758,6 +804,19 @@ extern "C" {
 	#define portTASK_USES_FLOATING_POINT()
 #endif
 
+#ifndef portHAS_STACK_OVERFLOW_CHECKING
+	/* Set to 1 by ports that detect stack overflows in hardware.  They are
+	passed the end of the stack when a task is created. */
+	#define portHAS_STACK_OVERFLOW_CHECKING 0
+#endif
+
+#ifndef portSTACK_GUARD_SIZE
+	/* The number of bytes at the end of each task stack that the port
+	protects against any access by the task.  They are left out of the stack
+	high water mark. */
+	#define portSTACK_GUARD_SIZE 0
+#endif
+
 #ifndef portTASK_CALLS_SECURE_FUNCTIONS
 	#define portTASK_CALLS_SECURE_FUNCTIONS()
 #endif
@@ -766,6 +825,20 @@ extern "C" {
 	#define configUSE_TIME_SLICING 1
 #endif
 
+#ifndef configNUMBER_OF_CORES
+	#define configNUMBER_OF_CORES 1
+#endif
+
+#ifndef configUSE_CORE_AFFINITY
+	#define configUSE_CORE_AFFINITY 0
+#endif
+
+#if ( configNUMBER_OF_CORES > 1 )
+	#ifndef portGET_CORE_ID
+		#error configNUMBER_OF_CORES > 1 requires a port that supports more than one core
+	#endif
+#endif
+
 #ifndef configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS
 	#define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 0
 #endif
@@ -1010,7 +1083,10 @@ typedef struct xSTATIC_TCB
 		void			*pvDummy15[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
 	#endif
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
-		uint32_t		ulDummy16;
+		configRUN_TIME_COUNTER_TYPE	ulDummy16;
+		#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+			configRUN_TIME_COUNTER_TYPE	ulDummy24;
+		#endif
 	#endif
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		struct	_reent	xDummy17;
@@ -1026,6 +1102,10 @@ typedef struct xSTATIC_TCB
 	#if( INCLUDE_xTaskAbortDelay == 1 )
 		uint8_t ucDummy21;
 	#endif
+	#if ( configNUMBER_OF_CORES > 1 )
+		BaseType_t		xDummy22;
+		UBaseType_t		uxDummy23;
+	#endif
 
 } StaticTask_t;
 
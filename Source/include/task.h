@@ -133,7 +133,8 @@ typedef struct xTASK_STATUS
 	eTaskState eCurrentState;		/* The state in which the task existed when the structure was populated. */
 	UBaseType_t uxCurrentPriority;	/* The priority at which the task was running (may be inherited) when the structure was populated. */
 	UBaseType_t uxBasePriority;		/* The priority to which the task will return if the task's current priority has been inherited to avoid unbounded priority inversion when obtaining a mutex.  Only valid if configUSE_MUTEXES is defined as 1 in FreeRTOSConfig.h. */
-	uint32_t ulRunTimeCounter;		/* The total run time allocated to the task so far, as defined by the run time stats clock.  See http://www.freertos.org/rtos-run-time-stats.html.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h. */
+	configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;		/* The total run time allocated to the task so far, as defined by the run time stats clock.  See http://www.freertos.org/rtos-run-time-stats.html.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h. */
+	configRUN_TIME_COUNTER_TYPE ulRunTimeInstructionCounter;	/* The number of instructions the task has executed so far.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h and the port defines portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE(), zero otherwise. */
 	StackType_t *pxStackBase;		/* Points to the lowest address of the task's stack area. */
 	uint16_t usStackHighWaterMark;	/* The minimum amount of stack space that has remained for the task since the task was created.  The closer this value is to zero the closer the task has come to overflowing its stack. */
 } TaskStatus_t;
@@ -153,6 +154,14 @@ typedef enum
  */
 #define tskIDLE_PRIORITY			( ( UBaseType_t ) 0U )
 
+/**
+ * Core affinity mask that allows a task to run on every core.  This is the
+ * affinity of a newly created task.
+ *
+ * \ingroup TaskUtils
+ */
+#define tskNO_AFFINITY				( ( UBaseType_t ) -1 )
+
 /**
  * task. h
  *
@@ -192,6 +201,25 @@ typedef enum
  */
 #define taskEXIT_CRITICAL()			portEXIT_CRITICAL()
 #define taskEXIT_CRITICAL_FROM_ISR( x ) portCLEAR_INTERRUPT_MASK_FROM_ISR( x )
+
+/**
+ * task. h
+ *
+ * Critical section that is only taken when configNUMBER_OF_CORES is greater
+ * than 1.  vTaskSuspendAll() then only holds off context switches on the
+ * calling core, so kernel code that relies on the scheduler being suspended
+ * to access data shared with other tasks uses these as well.
+ *
+ * \defgroup taskENTER_CRITICAL_SMP taskENTER_CRITICAL_SMP
+ * \ingroup SchedulerControl
+ */
+#if ( configNUMBER_OF_CORES > 1 )
+	#define taskENTER_CRITICAL_SMP()	taskENTER_CRITICAL()
+	#define taskEXIT_CRITICAL_SMP()		taskEXIT_CRITICAL()
+#else
+	#define taskENTER_CRITICAL_SMP()
+	#define taskEXIT_CRITICAL_SMP()
+#endif
 /**
  * task. h
  *
@@ -1003,6 +1031,58 @@ void vTaskGetInfo( TaskHandle_t xTask, TaskStatus_t *pxTaskStatus, BaseType_t xG
  */
 void vTaskPrioritySet( TaskHandle_t xTask, UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask );</pre>
+ *
+ * configNUMBER_OF_CORES must be greater than 1 and configUSE_CORE_AFFINITY
+ * must be defined as 1 for this function to be available.
+ *
+ * Set the cores a task may run on.  Bit n of uxCoreAffinityMask allows the
+ * task to run on core n, tskNO_AFFINITY allows it to run on every core.  A
+ * task running on a core it is no longer allowed to use is switched out.
+ *
+ * @param xTask Handle to the task for which the affinity is being set.
+ * Passing a NULL handle results in the affinity of the calling task being set.
+ *
+ * @param uxCoreAffinityMask The cores the task may run on.  At least one bit
+ * of a core that exists must be set.
+ *
+ * Example usage:
+   <pre>
+ void vAFunction( void )
+ {
+ TaskHandle_t xHandle;
+
+	 // Create a task, storing the handle.
+	 xTaskCreate( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, &xHandle );
+
+	 // Only let the task run on core 1.
+	 vTaskCoreAffinitySet( xHandle, ( 1 << 1 ) );
+ }
+   </pre>
+ * \defgroup vTaskCoreAffinitySet vTaskCoreAffinitySet
+ * \ingroup TaskCtrl
+ */
+void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask );</pre>
+ *
+ * configNUMBER_OF_CORES must be greater than 1 and configUSE_CORE_AFFINITY
+ * must be defined as 1 for this function to be available.
+ *
+ * @param xTask Handle to the task to query.  Passing a NULL handle returns the
+ * affinity of the calling task.
+ *
+ * @return The core affinity mask of the task, see vTaskCoreAffinitySet().
+ *
+ * \defgroup uxTaskCoreAffinityGet uxTaskCoreAffinityGet
+ * \ingroup TaskCtrl
+ */
+UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <pre>void vTaskSuspend( TaskHandle_t xTaskToSuspend );</pre>
@@ -1236,6 +1316,10 @@ void vTaskEndScheduler( void ) PRIVILEGED_FUNCTION;
  * vTaskDelayUntil(), xQueueSend(), etc.) must not be called while the scheduler
  * is suspended.
  *
+ * When configNUMBER_OF_CORES is greater than 1 only the calling core stops
+ * switching tasks.  The tasks on the other cores keep running, so data shared
+ * with them has to be protected by a critical section or a mutex instead.
+ *
  * Example usage:
    <pre>
  void vTask1( void * pvParameters )
@@ -1526,7 +1610,7 @@ TaskHandle_t xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
 	{
 	TaskStatus_t *pxTaskStatusArray;
 	volatile UBaseType_t uxArraySize, x;
-	uint32_t ulTotalRunTime, ulStatsAsPercentage;
+	configRUN_TIME_COUNTER_TYPE ulTotalRunTime, ulStatsAsPercentage;
 
 		// Make sure the write buffer does not contain a string.
 		*pcWriteBuffer = 0x00;
@@ -1580,7 +1664,7 @@ TaskHandle_t xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
 	}
 	</pre>
  */
-UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime ) PRIVILEGED_FUNCTION;
+UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, configRUN_TIME_COUNTER_TYPE * const pulTotalRunTime ) PRIVILEGED_FUNCTION;
 
 /**
  * task. h
@@ -1650,7 +1734,10 @@ void vTaskList( char * pcWriteBuffer ) PRIVILEGED_FUNCTION; /*lint !e971 Unquali
  * configured by the portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() macro.
  * Calling vTaskGetRunTimeStats() writes the total execution time of each
  * task into a buffer, both as an absolute count value and as a percentage
- * of the total system execution time.
+ * of the total system execution time.  Ports that define
+ * portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE() add the number of instructions
+ * each task executed after the count value.  Counters wider than int are
+ * printed with %llu.
  *
  * NOTE 2:
  *
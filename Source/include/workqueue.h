@@ -0,0 +1,116 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h" must appear in source files before "include workqueue.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Deferred interrupt handling.
+ *
+ * The work queue runs functions on behalf of interrupt handlers in a small
+ * number of shared worker tasks, so drivers do not need a task of their own
+ * for their bottom half.  There is one worker per lane.  Lane 0 runs at
+ * configWORK_QUEUE_TASK_PRIORITY, every further lane one priority below the
+ * previous one.  The items of a lane run one after the other in the order
+ * they were submitted.
+ *
+ * Work items are allocated by the application and set up once with
+ * vWorkItemInit().  Submitting an item that is still pending does not queue
+ * it a second time, so the function has to process everything that happened
+ * up to the time it runs, e.g. all frames a network interface has received.
+ * An item that is submitted again while its function runs is queued again.
+ *
+ * The workers are created by vTaskStartScheduler() when configUSE_WORK_QUEUES
+ * is set to 1 in FreeRTOSConfig.h.
+ *----------------------------------------------------------*/
+
+typedef void (*WorkFunction_t)( void *pvParameter );
+
+/*
+ * The members are private, a work item must only be accessed through the
+ * functions below.
+ */
+typedef struct xWORK_ITEM
+{
+	struct xWORK_ITEM *pxNext;		/*< The next pending item of the lane. */
+	WorkFunction_t pxFunction;		/*< The function the worker calls. */
+	void *pvParameter;				/*< The parameter passed to pxFunction. */
+	UBaseType_t uxLane;				/*< The lane the item is queued on. */
+	volatile BaseType_t xPending;	/*< pdTRUE while the item is queued. */
+} WorkItem_t;
+
+/**
+ * Prepares a work item, which must not be pending.
+ *
+ * @param pxItem The item, which has to remain valid while it can be submitted.
+ *
+ * @param pxFunction The function the worker of the lane calls.
+ *
+ * @param pvParameter Passed to pxFunction.
+ *
+ * @param uxLane The lane, from 0 (highest priority) to
+ * configWORK_QUEUE_LANES - 1.
+ */
+void vWorkItemInit( WorkItem_t *pxItem, WorkFunction_t pxFunction, void *pvParameter, UBaseType_t uxLane ) PRIVILEGED_FUNCTION;
+
+/**
+ * Queues a work item at the end of its lane and wakes the worker.
+ *
+ * @return pdPASS if the item was queued, pdFALSE if it was already pending.
+ */
+BaseType_t xWorkQueueSubmit( WorkItem_t *pxItem ) PRIVILEGED_FUNCTION;
+
+/**
+ * Version of xWorkQueueSubmit() that can be called from an interrupt handler.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the worker has a higher
+ * priority than the interrupted task, in which case a context switch should
+ * be requested before the handler returns.  Can be NULL.
+ *
+ * @return pdPASS if the item was queued, pdFALSE if it was already pending.
+ */
+BaseType_t xWorkQueueSubmitFromISR( WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*
+ * Functions beyond this part are not part of the public API and are intended
+ * for use by the kernel only.
+ */
+BaseType_t xWorkQueueCreateWorkers( void ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORK_QUEUE_H */
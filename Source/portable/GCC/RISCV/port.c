@@ -74,10 +74,14 @@
  * Implementation of functions defined in portable.h for the RISC-V port.
  *----------------------------------------------------------*/
 
+/* Standard includes. */
+#include <string.h>
+
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "portmacro.h"
+#include "portcontext.h"
 
 
 /* A variable is used to keep track of the critical section nesting.  This
@@ -87,6 +91,89 @@ the scheduler starts.  As it is stored as part of the task context it will
 automatically be set to 0 when the first task is started. */
 static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
 
+/* Priority threshold register of the PLIC context of the calling hart. */
+#define portPLIC_THRESHOLD()	( ( volatile uint32_t * ) ( portPLIC_THRESHOLD_ADDRESS + ( ( UBaseType_t ) portGET_CORE_ID() << portPLIC_CONTEXT_SHIFT ) ) )
+
+/* The tick and software interrupt enable bits that portENABLE_INTERRUPTS()
+sets again.  They stay clear until the scheduler has programmed the first
+tick. */
+static UBaseType_t uxKernelInterruptEnable = 0;
+
+/* msip register of a hart, see vPortPendYield(). */
+#define portCLINT_MSIP( xHartID )	( ( volatile uint32_t * ) ( portCLINT_MSIP_ADDRESS + ( ( UBaseType_t ) ( xHartID ) << portCLINT_MSIP_SHIFT ) ) )
+
+/* The interrupt mask returned by portSET_INTERRUPT_MASK_FROM_ISR() holds the
+PLIC threshold in the low bits and the masked mie bits above this shift. */
+#define portMASK_MIE_SHIFT			16
+
+/* Global machine interrupt enable.  The functions below clear it while they
+change mie and the PLIC threshold, so no interrupt sees only half of the new
+mask and the task cannot move to another hart in between. */
+#define portMSTATUS_MIE				0x8
+
+/* The number of interrupts that are currently running on the interrupt stack.
+The trap entry code only switches to the interrupt stack when this is zero, so
+nested handlers continue on the stack of the handler they interrupted. */
+#if( configNUMBER_OF_CORES > 1 )
+	volatile UBaseType_t uxPortInterruptNesting[ configNUMBER_OF_CORES ] = { 0 };
+#else
+	volatile UBaseType_t uxPortInterruptNesting = 0;
+#endif
+
+#if( configNUMBER_OF_CORES > 1 )
+
+	/* Hart 0 uses the interrupt stack reserved by the linker script, the
+	other harts get theirs from here. */
+	#ifndef configISR_STACK_SIZE_WORDS
+		#define configISR_STACK_SIZE_WORDS	( 8192 / sizeof( StackType_t ) )
+	#endif
+
+	extern StackType_t _isr_stack[];
+	static StackType_t xSecondaryISRStacks[ configNUMBER_OF_CORES - 1 ][ configISR_STACK_SIZE_WORDS ] __attribute__( ( aligned( 16 ) ) );
+
+	/* Top of the interrupt stack of every hart, read by portasm.S and boot.S. */
+	StackType_t *pxPortISRStackTops[ configNUMBER_OF_CORES ];
+
+	/* A recursive spinlock.  xOwner is only ever set to the ID of a hart by
+	that hart itself, so a hart can check whether it already holds the lock
+	without taking it. */
+	typedef struct PORT_LOCK
+	{
+		volatile uint32_t ulLock;
+		volatile BaseType_t xOwner;
+		UBaseType_t uxCount;
+	} PortLock_t;
+
+	static PortLock_t xTaskLock = { 0, -1, 0 };
+	static PortLock_t xISRLock = { 0, -1, 0 };
+
+#endif /* configNUMBER_OF_CORES */
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+	/* Per hart state of the run time counters.  uxISRStatsNesting counts the
+	handlers that are running, the counter values at the start of the
+	outermost one are kept while it runs.  The total time spent in handlers
+	is taken off mcycle and minstret to form the task clocks. */
+	static UBaseType_t uxISRStatsNesting[ configNUMBER_OF_CORES ] = { 0 };
+	static PortISRSample_t xISRStart[ configNUMBER_OF_CORES ];
+	static PortISRSample_t xISRTotal[ configNUMBER_OF_CORES ];
+
+	/* The tick runs on every hart, so its statistics are kept per hart. */
+	static PortISRStats_t xTickISRStats[ configNUMBER_OF_CORES ];
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+
+	/* Time from mtimecmp to the tick handler, per hart like the tick. */
+	static PortLatencyStats_t xTickLatency[ configNUMBER_OF_CORES ];
+
+	/* mcycle cycles per mtime increment. */
+	#define portCYCLES_PER_TIMER_INCREMENT	( configCPU_CLOCK_HZ / configTICK_CLOCK_HZ )
+
+#endif /* configUSE_IRQ_LATENCY_STATS */
+
 /* Contains context when starting scheduler, save all 31 registers */
 #ifdef __gracefulExit
 BaseType_t xStartContext[31] = {0};
@@ -108,46 +195,359 @@ volatile uint64_t* timecmp =    (uint64_t*)(CLINT_BASE + 0x4000);
  */
 void vPortSysTickHandler( void );
 
+/*
+ * Advance the tick, called by vPortSysTickHandler().
+ */
+static void prvTickHandler( void );
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
 void vPortSetupTimer( void );
 
+#if ( configNUMBER_OF_CORES > 1 )
+	/*
+	 * Release the other harts from boot.S, and bring up the tick of such a
+	 * hart before it restores its first task.
+	 */
+	void vPortStartSecondaryHarts( void );
+	void vPortSetupSecondaryHart( void );
+#endif
+
 /*
- * Set the next interval for the timer
+ * Advance the tick deadline past the current time and program it into
+ * mtimecmp.  Returns the number of tick periods that have elapsed.
  */
-static void prvSetNextTimerInterrupt( void );
+static UBaseType_t prvSetNextTimerInterrupt( void );
 
 /*
  * Used to catch tasks that attempt to return from their implementing function.
  */
 static void prvTaskExitError( void );
 
+/*
+ * Called by boot.S on a load or store access fault, from the interrupt stack.
+ * Reports a hit of the stack guard of the running task and returns otherwise.
+ */
+void vPortAccessFault( UBaseType_t uxCause, UBaseType_t uxAddress );
+
+#if( configENABLE_PMP_STACK_GUARD == 1 )
+	/*
+	 * Program the PMP entries of the stack guard and let them apply to the
+	 * tasks on the calling hart.
+	 */
+	void vPortSetupStackGuard( void );
+
+	#if( ( INCLUDE_xTaskGetCurrentTaskHandle == 0 ) && ( configUSE_MUTEXES == 0 ) && ( configNUMBER_OF_CORES == 1 ) )
+		#error configENABLE_PMP_STACK_GUARD needs xTaskGetCurrentTaskHandle(), set INCLUDE_xTaskGetCurrentTaskHandle to 1
+	#endif
+
+	extern void vApplicationStackOverflowHook( TaskHandle_t xTask, char *pcTaskName );
+#endif
+
+/*
+ * Read mtime and write mtimecmp without tearing the 64-bit values on RV32.
+ */
+static uint64_t prvReadTimer( void );
+static void prvWriteTimerCompare( uint64_t ullCompare );
+
+/*
+ * Thread local storage, see link.ld.  .tdata holds the initial values of the
+ * __thread variables and .tbss the zero initialised ones.  Every task gets a
+ * copy of both at the top of its stack and tp pointing at it, which is what
+ * the local exec TLS model of RISC-V expects: a variable lives at tp plus its
+ * offset from __tdata_start.  main has its block in .bss, see boot.S, so the
+ * image is never written.  Interrupt handlers use the block of the task they
+ * interrupted.
+ */
+extern char __tdata_start[], __tdata_end[], __tbss_end[];
+
+/* link.ld aligns .tdata to this, which also keeps the stack aligned. */
+#define portTLS_ALIGNMENT	16
+
+/*
+ * The number of mtime increments that make up one tick period.
+ */
+static const uint64_t ullTimerIncrementsForOneTick = ( configTICK_CLOCK_HZ / configTICK_RATE_HZ );
+
+/*
+ * The absolute mtime value at which the next tick of each hart is due.  It
+ * only ever advances in whole tick periods so the tick stays locked to mtime
+ * no matter how late the tick interrupt is serviced.
+ */
+static uint64_t ullNextTickTime[ configNUMBER_OF_CORES ] = { 0 };
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvReadTimer( void )
+{
+#if __riscv_xlen == 32
+	volatile uint32_t * const pulTime = ( volatile uint32_t * ) mtime;
+	uint32_t ulHigh, ulLow;
+
+	/* Re-read if the low word wrapped between the two reads. */
+	do
+	{
+		ulHigh = pulTime[ 1 ];
+		ulLow = pulTime[ 0 ];
+	} while( ulHigh != pulTime[ 1 ] );
+
+	return ( ( uint64_t ) ulHigh << 32 ) | ulLow;
+#else
+	return *mtime;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteTimerCompare( uint64_t ullCompare )
+{
+#if __riscv_xlen == 32
+	volatile uint32_t * const pulTimeCompare = ( volatile uint32_t * ) ( timecmp + portGET_CORE_ID() );
+
+	/* Park the low word at its maximum first so no intermediate value can
+	raise a spurious timer interrupt. */
+	pulTimeCompare[ 0 ] = 0xFFFFFFFFUL;
+	pulTimeCompare[ 1 ] = ( uint32_t ) ( ullCompare >> 32 );
+	pulTimeCompare[ 0 ] = ( uint32_t ) ullCompare;
+#else
+	timecmp[ portGET_CORE_ID() ] = ullCompare;
+#endif
+}
 /*-----------------------------------------------------------*/
 
 /* Sets the next timer interrupt
- * Reads current timer register and adds tickrate
- * Does nothing if a Clint was not found in the hardware configuration string
- * Using previous timer compare may fail if interrupts were disabled for a long time,
- * which is likely for the very first interrupt. When that happens, compare timer + 
- * tickrate may already be behind current timer and prevent correctly programming
- * the 2nd interrupt
+ * Advances the absolute deadline by exactly one tick period, or by as many
+ * periods as have passed if interrupts were masked for longer than a tick, so
+ * handler latency never accumulates into drift and no tick is lost.  The
+ * division is only needed in the catch-up case.
  */
-static void prvSetNextTimerInterrupt(void)
+static UBaseType_t prvSetNextTimerInterrupt(void)
 {
-    if (mtime && timecmp) 
-        *timecmp = *mtime + (configTICK_CLOCK_HZ / configTICK_RATE_HZ);
+	uint64_t * const pullNextTickTime = &ullNextTickTime[ portGET_CORE_ID() ];
+	uint64_t ullNow = prvReadTimer();
+	UBaseType_t uxElapsed;
+
+	if( ullNow < *pullNextTickTime )
+	{
+		/* The deadline has not been reached yet, nothing to do. */
+		return 0;
+	}
+
+	uxElapsed = 1;
+	if( ( ullNow - *pullNextTickTime ) >= ullTimerIncrementsForOneTick )
+	{
+		uxElapsed += ( UBaseType_t ) ( ( ullNow - *pullNextTickTime ) / ullTimerIncrementsForOneTick );
+	}
+
+	*pullNextTickTime += ( uint64_t ) uxElapsed * ullTimerIncrementsForOneTick;
+	prvWriteTimerCompare( *pullNextTickTime );
+
+	return uxElapsed;
 }
 /*-----------------------------------------------------------*/
 
 /* Sets and enable the timer interrupt */
 void vPortSetupTimer(void)
 {
-    /* reuse existing routine */
-    prvSetNextTimerInterrupt();
+    uint64_t * const pullNextTickTime = &ullNextTickTime[ portGET_CORE_ID() ];
+
+    /* the first tick is one period from now, later ones are relative to it */
+    *pullNextTickTime = prvReadTimer() + ullTimerIncrementsForOneTick;
+    prvWriteTimerCompare( *pullNextTickTime );
+
+	/* Enable timer and software interupt */
+	uxKernelInterruptEnable = portMIE_KERNEL;
+	__asm volatile("csrs mie,%0"::"r"(portMIE_KERNEL));
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullPortGetTimeStamp( TickType_t *pxTickCount )
+{
+uint64_t ullTime;
+int xSavedMask;
+
+	if( pxTickCount == NULL )
+	{
+		return prvReadTimer();
+	}
+
+	/* Keep the tick interrupt from updating the tick count between the two
+	reads. */
+	xSavedMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		ullTime = prvReadTimer();
+		*pxTickCount = xTaskGetTickCountFromISR();
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( xSavedMask );
+
+	return ullTime;
+}
+/*-----------------------------------------------------------*/
+
+/* Pend a context switch, it is performed by the machine software interrupt as
+ * soon as the kernel interrupts are unmasked and no handler is running. */
+void vPortPendYield( void )
+{
+	*portCLINT_MSIP( portGET_CORE_ID() ) = 1;
+}
+/*-----------------------------------------------------------*/
+
+#if( configNUMBER_OF_CORES > 1 )
+
+	/* Reschedule another hart through its machine software interrupt.  The
+	fence makes the kernel data the calling hart has written visible before
+	the other hart takes the interrupt. */
+	void vPortYieldCore( BaseType_t xCoreID )
+	{
+		if( xCoreID == portGET_CORE_ID() )
+		{
+			vPortPendYield();
+		}
+		else
+		{
+			__asm volatile( "fence rw, o" ::: "memory" );
+			*portCLINT_MSIP( xCoreID ) = 1;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvGetLock( PortLock_t *pxLock )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+	uint32_t ulPrevious;
+
+		if( pxLock->xOwner == xCoreID )
+		{
+			pxLock->uxCount++;
+			return;
+		}
+
+		for( ;; )
+		{
+			/* Spin on plain loads so waiting harts do not keep stealing the
+			cache line from the owner. */
+			while( pxLock->ulLock != 0 )
+			{
+			}
+
+			__asm volatile( "amoswap.w.aq %0, %2, %1" : "=r"( ulPrevious ), "+A"( pxLock->ulLock ) : "r"( 1 ) : "memory" );
+			if( ulPrevious == 0 )
+			{
+				break;
+			}
+		}
+
+		pxLock->xOwner = xCoreID;
+		pxLock->uxCount = 1;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvReleaseLock( PortLock_t *pxLock )
+	{
+		configASSERT( pxLock->xOwner == portGET_CORE_ID() );
+
+		pxLock->uxCount--;
+		if( pxLock->uxCount == 0 )
+		{
+			pxLock->xOwner = -1;
+			__asm volatile( "amoswap.w.rl x0, x0, %0" : "+A"( pxLock->ulLock ) :: "memory" );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/* The kernel locks are only taken with the kernel interrupts masked. */
+	void vPortGetTaskLock( void )
+	{
+		prvGetLock( &xTaskLock );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortReleaseTaskLock( void )
+	{
+		prvReleaseLock( &xTaskLock );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetISRLock( void )
+	{
+		prvGetLock( &xISRLock );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortReleaseISRLock( void )
+	{
+		prvReleaseLock( &xISRLock );
+	}
+	/*-----------------------------------------------------------*/
+
+	int xPortSetInterruptMaskFromISR( void )
+	{
+	int xSavedMask = vPortSetInterruptMask();
+
+		prvGetLock( &xISRLock );
+		return xSavedMask;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortClearInterruptMaskFromISR( int xSavedMask )
+	{
+		prvReleaseLock( &xISRLock );
+		vPortClearInterruptMask( xSavedMask );
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Called by hart 0 from xPortStartScheduler().  The other harts wait in
+	boot.S for their software interrupt and then enter
+	xPortStartSecondaryHart. */
+	void vPortStartSecondaryHarts( void )
+	{
+	BaseType_t x;
+
+		pxPortISRStackTops[ 0 ] = _isr_stack;
+		for( x = 1; x < configNUMBER_OF_CORES; x++ )
+		{
+			pxPortISRStackTops[ x ] = &xSecondaryISRStacks[ x - 1 ][ configISR_STACK_SIZE_WORDS ];
+		}
+
+		for( x = 1; x < configNUMBER_OF_CORES; x++ )
+		{
+			vPortYieldCore( x );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortSetupSecondaryHart( void )
+	{
+		/* Acknowledge the software interrupt that released this hart. */
+		*portCLINT_MSIP( portGET_CORE_ID() ) = 0;
+		#if( configENABLE_PMP_STACK_GUARD == 1 )
+		{
+			vPortSetupStackGuard();
+		}
+		#endif
+		vPortSetupTimer();
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configNUMBER_OF_CORES */
+
+/* Switch right away with the short voluntary frame, unless the calling task is
+ * inside a critical section.  The switch is pended then, so it happens when
+ * the critical section is left instead of unmasking interrupts in the middle
+ * of it. */
+void vPortYieldFromTask( void )
+{
+	UBaseType_t uxEnabled;
 
-	/* Enable timer interupt */
-	__asm volatile("csrs mie,%0"::"r"(0x80));
+	__asm volatile("csrr %0,mie":"=r"(uxEnabled));
+	if( ( uxEnabled & portMIE_MSIE ) != 0 )
+	{
+		vPortYield();
+	}
+	else
+	{
+		vPortPendYield();
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -165,19 +565,77 @@ void prvTaskExitError( void )
 }
 /*-----------------------------------------------------------*/
 
+/* Mask the tick, pended yields and all external interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY.  mstatus.MIE is only cleared while the
+ * mask is changed, so higher priority sources are still taken inside the
+ * critical section.  The threshold is read back so it is in effect before the
+ * critical section starts. */
+void vPortDisableInterrupts(void)
+{
+	UBaseType_t uxStatus;
+	volatile uint32_t *pulPLICThreshold;
+
+	__asm volatile("csrrc %0,mstatus,%1":"=r"(uxStatus):"r"(portMSTATUS_MIE));
+	pulPLICThreshold = portPLIC_THRESHOLD();
+	__asm volatile("csrc mie,%0"::"r"(portMIE_KERNEL));
+	*pulPLICThreshold = configMAX_SYSCALL_INTERRUPT_PRIORITY;
+	( void ) *pulPLICThreshold;
+	__asm volatile("csrs mstatus,%0"::"r"(uxStatus & portMSTATUS_MIE));
+}
+/*-----------------------------------------------------------*/
+
+/* Lower the PLIC threshold and unmask the tick and software interrupt again */
+void vPortEnableInterrupts(void)
+{
+	UBaseType_t uxStatus;
+
+	__asm volatile("csrrc %0,mstatus,%1":"=r"(uxStatus):"r"(portMSTATUS_MIE));
+	*portPLIC_THRESHOLD() = 0;
+	__asm volatile("csrs mie,%0"::"r"(uxKernelInterruptEnable));
+	__asm volatile("csrs mstatus,%0"::"r"(uxStatus & portMSTATUS_MIE));
+}
+/*-----------------------------------------------------------*/
+
 /* Clear current interrupt mask and set given mask */
 void vPortClearInterruptMask(int mask)
 {
-	__asm volatile("csrw mie, %0"::"r"(mask));
+	UBaseType_t uxStatus;
+
+	__asm volatile("csrrc %0,mstatus,%1":"=r"(uxStatus):"r"(portMSTATUS_MIE));
+	*portPLIC_THRESHOLD() = ( uint32_t ) ( mask & ( ( 1 << portMASK_MIE_SHIFT ) - 1 ) );
+	__asm volatile("csrs mie,%0"::"r"( ( mask >> portMASK_MIE_SHIFT ) & portMIE_KERNEL ));
+	__asm volatile("csrs mstatus,%0"::"r"(uxStatus & portMSTATUS_MIE));
 }
 /*-----------------------------------------------------------*/
 
-/* Set interrupt mask and return current interrupt enable register */
+/* Set interrupt mask and return the previous mask, made up of the PLIC
+ * threshold and the tick and software interrupt enable bits.  The threshold is
+ * only ever raised, so an interrupt running above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY keeps its own.  Reading the old mask and
+ * writing the new one happens with mstatus.MIE clear, so a nested interrupt
+ * cannot change the threshold in between. */
 int vPortSetInterruptMask(void)
 {
 	int ret;
-	__asm volatile("csrr %0,mie":"=r"(ret));
-	__asm volatile("csrc mie,%0"::"i"(7));
+	UBaseType_t uxStatus;
+	volatile uint32_t *pulPLICThreshold;
+	uint32_t ulThreshold;
+
+	__asm volatile("csrrc %0,mstatus,%1":"=r"(uxStatus):"r"(portMSTATUS_MIE));
+	pulPLICThreshold = portPLIC_THRESHOLD();
+	ulThreshold = *pulPLICThreshold;
+
+	__asm volatile("csrrc %0,mie,%1":"=r"(ret):"r"(portMIE_KERNEL));
+	ret = ( ( ret & portMIE_KERNEL ) << portMASK_MIE_SHIFT ) | ( int ) ulThreshold;
+
+	if( ulThreshold < configMAX_SYSCALL_INTERRUPT_PRIORITY )
+	{
+		*pulPLICThreshold = configMAX_SYSCALL_INTERRUPT_PRIORITY;
+		( void ) *pulPLICThreshold;
+	}
+
+	__asm volatile("csrs mstatus,%0"::"r"(uxStatus & portMSTATUS_MIE));
+
 	return ret;
 }
 /*-----------------------------------------------------------*/
@@ -186,32 +644,468 @@ int vPortSetInterruptMask(void)
 /*
  * See header file for description.
  */
+#if( portHAS_STACK_OVERFLOW_CHECKING == 1 )
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, StackType_t *pxEndOfStack, TaskFunction_t pxCode, void *pvParameters )
+#else
 StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+#endif
 {
+const size_t xTLSDataSize = ( size_t ) ( __tdata_end - __tdata_start );
+const size_t xTLSSize = ( size_t ) ( __tbss_end - __tdata_start );
+char *pcTLS;
+
+	/* The TLS block of the task is taken off the top of its stack, so it
+	costs stack depth rather than heap and goes away with the task. */
+	pcTLS = ( char * ) ( ( ( UBaseType_t ) pxTopOfStack - xTLSSize ) & ~( ( UBaseType_t ) portTLS_ALIGNMENT - 1 ) );
+	memcpy( pcTLS, __tdata_start, xTLSDataSize );
+	memset( pcTLS + xTLSDataSize, 0, xTLSSize - xTLSDataSize );
+	pxTopOfStack = ( StackType_t * ) pcTLS;
+
+	#if defined( __riscv_flen ) || defined( __riscv_vector )
+	{
+		/* The FPU and vector registers are kept in a save area right below
+		the TLS block, where the context switch code finds it through tp.  It
+		is only read once the task has saved into it. */
+		pxTopOfStack -= portSAVE_AREA_SIZE / sizeof( StackType_t );
+	}
+	#endif
+
 	/* Simulate the stack frame as it would be created by a context switch
-	interrupt. */
-	register int *tp asm("x3");
-	pxTopOfStack--;
-	*pxTopOfStack = (portSTACK_TYPE)pxCode;			/* Start address */
-	pxTopOfStack -= 22;
-	*pxTopOfStack = (portSTACK_TYPE)pvParameters;	/* Register a0 */
-	pxTopOfStack -= 6;
-	*pxTopOfStack = (portSTACK_TYPE)tp; /* Register thread pointer */
-	pxTopOfStack -= 3;
-	*pxTopOfStack = (portSTACK_TYPE)prvTaskExitError; /* Register ra */
-	
+	interrupt.  The frame layout is described in portcontext.h. */
+	pxTopOfStack -= portCONTEXT_SIZE / sizeof( StackType_t );
+	pxTopOfStack[ 31 ] = (portSTACK_TYPE)pxCode;			/* Start address */
+	pxTopOfStack[ portFRAME_TYPE_OFFSET / sizeof( StackType_t ) ] = portFRAME_FULL;
+	pxTopOfStack[ 9 ] = (portSTACK_TYPE)pvParameters;	/* Register a0 */
+	pxTopOfStack[ 3 ] = (portSTACK_TYPE)pcTLS;		/* Register tp */
+	pxTopOfStack[ 0 ] = (portSTACK_TYPE)prvTaskExitError; /* Register ra */
+
+	#if( configENABLE_PMP_STACK_GUARD == 1 )
+	{
+		/* pmpaddr0 value of the task, the guard starts at the end of the
+		stack. */
+		pxTopOfStack[ portSTACK_GUARD_OFFSET / sizeof( StackType_t ) ] = ( StackType_t ) ( ( UBaseType_t ) pxEndOfStack >> 2 );
+	}
+	#endif
+
+	#ifdef __riscv_flen
+	{
+		/* A new task has not used the FPU yet, so its registers are neither
+		saved nor restored until the task makes the FS state Dirty. */
+		pxTopOfStack[ portFPU_STATUS_OFFSET / sizeof( StackType_t ) ] = portMSTATUS_FS_INITIAL;
+	}
+	#endif
+
+	#ifdef __riscv_vector
+	{
+	UBaseType_t uxVectorLength;
+
+		/* The save area only has room for vector registers of the VLEN the
+		toolchain was told about. */
+		__asm volatile( "csrr %0, vlenb" : "=r"( uxVectorLength ) );
+		configASSERT( uxVectorLength == portVLENB );
+
+		/* Like the FPU, the vector unit starts in the Initial state. */
+		pxTopOfStack[ portVECTOR_STATUS_OFFSET / sizeof( StackType_t ) ] = portMSTATUS_VS_INITIAL;
+	}
+	#endif
+
 	return pxTopOfStack;
 }
 /*-----------------------------------------------------------*/
 
-void vPortSysTickHandler( void )
+#if( configENABLE_PMP_STACK_GUARD == 1 )
+
+	void vPortSetupStackGuard( void )
+	{
+		/* Entry 2 covers the whole address space, entries 0 and 1 are loaded
+		with the guard of each task by portRESTORE_CONTEXT. */
+		__asm volatile( "csrw pmpaddr0, zero" );
+		__asm volatile( "csrw pmpaddr1, zero" );
+		__asm volatile( "csrw pmpaddr2, %0" :: "r"( ~( UBaseType_t ) 0 ) );
+		__asm volatile( "csrw pmpcfg0, %0" :: "r"( portPMPCFG_STACK_GUARD ) );
+		__asm volatile( "csrs mstatus, %0" :: "r"( portMSTATUS_MPRV ) );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configENABLE_PMP_STACK_GUARD */
+
+void vPortAccessFault( UBaseType_t uxCause, UBaseType_t uxAddress )
+{
+	( void ) uxCause;
+
+	#if( configENABLE_PMP_STACK_GUARD == 1 )
+	{
+	UBaseType_t uxGuard;
+
+		/* pmpaddr0 stays zero until the first task is restored. */
+		__asm volatile( "csrr %0, pmpaddr0" : "=r"( uxGuard ) );
+		uxGuard <<= 2;
+
+		if( ( uxGuard != 0 ) && ( ( uxAddress - uxGuard ) < configPMP_STACK_GUARD_SIZE ) )
+		{
+			vApplicationStackOverflowHook( xTaskGetCurrentTaskHandle(), pcTaskGetName( NULL ) );
+		}
+	}
+	#else
+	{
+		( void ) uxAddress;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+portFAST_CODE void vPortSysTickHandler( void )
+{
+	#if( configUSE_IRQ_LATENCY_STATS == 1 )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+	uint64_t ullLate = prvReadTimer() - timecmp[ xCoreID ];
+
+		/* mtimecmp is only written by this hart, so it cannot tear here.  It
+		may have been moved beyond mtime since the interrupt was raised. */
+		if( ullLate > ( ( uint64_t ) 0xFFFFFFFFUL / portCYCLES_PER_TIMER_INCREMENT ) )
+		{
+			ullLate = 0;
+		}
+		vPortLatencyRecord( &xTickLatency[ xCoreID ], ( uint32_t ) ( ullLate * portCYCLES_PER_TIMER_INCREMENT ) );
+	}
+	#endif
+
+	#if( configGENERATE_RUN_TIME_STATS == 1 )
+	{
+	PortISRSample_t xSample;
+
+		vPortISRStatsEnter( &xSample );
+		prvTickHandler();
+		vPortISRStatsExit( &xSample, &xTickISRStats[ portGET_CORE_ID() ] );
+	}
+	#else
+	{
+		prvTickHandler();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickHandler( void )
 {
-	prvSetNextTimerInterrupt();
+UBaseType_t uxElapsed;
+BaseType_t xSwitchRequired = pdFALSE;
 
-	/* Increment the RTOS tick. */
-	if( xTaskIncrementTick() != pdFALSE )
+	uxElapsed = prvSetNextTimerInterrupt();
+
+	#if( configNUMBER_OF_CORES > 1 )
+	{
+		/* The tick count is kept by hart 0.  The tick of the other harts only
+		shares the processor time between tasks of equal priority. */
+		if( portGET_CORE_ID() != 0 )
+		{
+			#if( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
+			{
+				if( uxElapsed > 0 )
+				{
+					vTaskSwitchContext();
+				}
+			}
+			#endif
+			return;
+		}
+	}
+	#endif
+
+	/* Increment the RTOS tick once for every period that elapsed, so ticks
+	missed while interrupts were masked are processed in this one trap. */
+	while( uxElapsed > 0 )
+	{
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xSwitchRequired = pdTRUE;
+		}
+		uxElapsed--;
+	}
+
+	if( xSwitchRequired != pdFALSE )
 	{
 		vTaskSwitchContext();
 	}
 }
 /*-----------------------------------------------------------*/
+
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	{
+	uint64_t ullTickStart, ullWakeTime, ullNow, ullCompleteTickPeriods;
+	TickType_t xModifiableIdleTime;
+
+		/* Enter a critical section but don't use the taskENTER_CRITICAL()
+		method as that will mask interrupts that should exit sleep mode.  wfi
+		still wakes up on an interrupt that is enabled in mie while mstatus.MIE
+		is clear, and the interrupt is then taken once MIE is set again. */
+		__asm volatile( "csrc mstatus, 8" );
+
+		/* If a context switch is pending or a task is waiting for the scheduler
+		to be unsuspended then abandon the low power entry. */
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			__asm volatile( "csrs mstatus, 8" );
+			return;
+		}
+
+		/* ullNextTickTime holds the end of the current tick period.  Move it
+		out to the end of the last tick period the kernel is idle for.  mtime is
+		64 bits wide so there is no maximum to the number of suppressed ticks.
+		Tickless idle is only supported on a single hart. */
+		ullTickStart = ullNextTickTime[ 0 ] - ullTimerIncrementsForOneTick;
+		ullWakeTime = ullNextTickTime[ 0 ] + ( ( uint64_t ) ( xExpectedIdleTime - 1UL ) * ullTimerIncrementsForOneTick );
+		ullNextTickTime[ 0 ] = ullWakeTime;
+		prvWriteTimerCompare( ullNextTickTime[ 0 ] );
+
+		/* Sleep until something happens.  configPRE_SLEEP_PROCESSING() can
+		set its parameter to 0 to indicate that its implementation contains
+		its own wait for interrupt or wait for event instruction, and so wfi
+		should not be executed again. */
+		xModifiableIdleTime = xExpectedIdleTime;
+		configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+		if( xModifiableIdleTime > 0 )
+		{
+			__asm volatile( "wfi" );
+		}
+		configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+		ullNow = prvReadTimer();
+
+		if( ullNow >= ullWakeTime )
+		{
+			/* The tick interrupt is pending and will account for the final
+			tick period, and any period that passed since, together with
+			programming the next one as soon as interrupts are enabled again. */
+			vTaskStepTick( xExpectedIdleTime - 1UL );
+		}
+		else
+		{
+			/* Something other than the tick interrupt ended the sleep.  Step
+			the tick count by the periods that completed and move mtimecmp back
+			to the end of the period mtime is currently in. */
+			ullCompleteTickPeriods = ( ullNow - ullTickStart ) / ullTimerIncrementsForOneTick;
+			ullNextTickTime[ 0 ] = ullTickStart + ( ( ullCompleteTickPeriods + 1ULL ) * ullTimerIncrementsForOneTick );
+			prvWriteTimerCompare( ullNextTickTime[ 0 ] );
+			vTaskStepTick( ( TickType_t ) ullCompleteTickPeriods );
+		}
+
+		__asm volatile( "csrs mstatus, 8" );
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+/* The statistics below are also updated by handlers above
+configMAX_SYSCALL_INTERRUPT_PRIORITY, so they are read with all interrupts
+disabled rather than just the kernel ones. */
+#define portDISABLE_ALL_INTERRUPTS( uxStatus )	__asm volatile( "csrrci %0, mstatus, 8" : "=r"( uxStatus ) )
+#define portRESTORE_ALL_INTERRUPTS( uxStatus )	__asm volatile( "csrs mstatus, %0" :: "r"( ( uxStatus ) & 8UL ) )
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+	/* Read a 64-bit machine counter, re-reading on RV32 if the low word
+	wrapped between the two halves. */
+	#if __riscv_xlen == 32
+		#define portREAD_COUNTER( ullValue, csr )										\
+		{																				\
+		uint32_t ulHigh, ulLow, ulCheck;												\
+																						\
+			do																			\
+			{																			\
+				__asm volatile( "csrr %0, " #csr "h" : "=r"( ulHigh ) );				\
+				__asm volatile( "csrr %0, " #csr : "=r"( ulLow ) );						\
+				__asm volatile( "csrr %0, " #csr "h" : "=r"( ulCheck ) );				\
+			} while( ulHigh != ulCheck );												\
+																						\
+			( ullValue ) = ( ( uint64_t ) ulHigh << 32 ) | ulLow;						\
+		}
+	#else
+		#define portREAD_COUNTER( ullValue, csr )										\
+			__asm volatile( "csrr %0, " #csr : "=r"( ullValue ) )
+	#endif
+
+	void vPortISRStatsEnter( PortISRSample_t *pxSample )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+
+		portREAD_COUNTER( pxSample->ullCycles, mcycle );
+		portREAD_COUNTER( pxSample->ullInstructions, minstret );
+
+		if( uxISRStatsNesting[ xCoreID ] == 0 )
+		{
+			xISRStart[ xCoreID ] = *pxSample;
+		}
+		uxISRStatsNesting[ xCoreID ]++;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortISRStatsExit( const PortISRSample_t *pxSample, PortISRStats_t *pxStats )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+	uint64_t ullCycles, ullInstructions;
+
+		portREAD_COUNTER( ullCycles, mcycle );
+		portREAD_COUNTER( ullInstructions, minstret );
+
+		pxStats->ullCycles += ullCycles - pxSample->ullCycles;
+		pxStats->ullInstructions += ullInstructions - pxSample->ullInstructions;
+		pxStats->ulCount++;
+
+		uxISRStatsNesting[ xCoreID ]--;
+		if( uxISRStatsNesting[ xCoreID ] == 0 )
+		{
+			xISRTotal[ xCoreID ].ullCycles += ullCycles - xISRStart[ xCoreID ].ullCycles;
+			xISRTotal[ xCoreID ].ullInstructions += ullInstructions - xISRStart[ xCoreID ].ullInstructions;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetTickISRStats( PortISRStats_t *pxStats )
+	{
+	BaseType_t x;
+	UBaseType_t uxStatus;
+
+		pxStats->ullCycles = 0;
+		pxStats->ullInstructions = 0;
+		pxStats->ulCount = 0;
+
+		/* The statistics of the other harts may still change while they are
+		summed up. */
+		portDISABLE_ALL_INTERRUPTS( uxStatus );
+		for( x = 0; x < configNUMBER_OF_CORES; x++ )
+		{
+			pxStats->ullCycles += xTickISRStats[ x ].ullCycles;
+			pxStats->ullInstructions += xTickISRStats[ x ].ullInstructions;
+			pxStats->ulCount += xTickISRStats[ x ].ulCount;
+		}
+		portRESTORE_ALL_INTERRUPTS( uxStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	/* The task clocks are mcycle and minstret less the time spent in interrupt
+	handlers.  While a handler runs they stay at the value they had when it
+	was entered, so a context switch from within the handler charges the
+	outgoing task up to the interrupt and the incoming one from its end. */
+	uint64_t ullPortGetRunTimeCounterValue( void )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+	uint64_t ullValue;
+	UBaseType_t uxStatus;
+
+		portDISABLE_ALL_INTERRUPTS( uxStatus );
+		if( uxISRStatsNesting[ xCoreID ] != 0 )
+		{
+			ullValue = xISRStart[ xCoreID ].ullCycles;
+		}
+		else
+		{
+			portREAD_COUNTER( ullValue, mcycle );
+		}
+		ullValue -= xISRTotal[ xCoreID ].ullCycles;
+		portRESTORE_ALL_INTERRUPTS( uxStatus );
+
+		return ullValue;
+	}
+	/*-----------------------------------------------------------*/
+
+	uint64_t ullPortGetRunTimeInstructionCounterValue( void )
+	{
+	const BaseType_t xCoreID = portGET_CORE_ID();
+	uint64_t ullValue;
+	UBaseType_t uxStatus;
+
+		portDISABLE_ALL_INTERRUPTS( uxStatus );
+		if( uxISRStatsNesting[ xCoreID ] != 0 )
+		{
+			ullValue = xISRStart[ xCoreID ].ullInstructions;
+		}
+		else
+		{
+			portREAD_COUNTER( ullValue, minstret );
+		}
+		ullValue -= xISRTotal[ xCoreID ].ullInstructions;
+		portRESTORE_ALL_INTERRUPTS( uxStatus );
+
+		return ullValue;
+	}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+
+	void vPortLatencyRecord( PortLatencyStats_t *pxStats, uint32_t ulCycles )
+	{
+	UBaseType_t uxBucket = 0;
+
+		if( ( pxStats->ulCount == 0 ) || ( ulCycles < pxStats->ulMin ) )
+		{
+			pxStats->ulMin = ulCycles;
+		}
+		if( ulCycles > pxStats->ulMax )
+		{
+			pxStats->ulMax = ulCycles;
+		}
+		pxStats->ulCount++;
+		pxStats->ullTotal += ulCycles;
+
+		if( ulCycles > 1 )
+		{
+			uxBucket = ( UBaseType_t ) ( 31 - __builtin_clz( ulCycles ) );
+			if( uxBucket >= portLATENCY_BUCKETS )
+			{
+				uxBucket = portLATENCY_BUCKETS - 1;
+			}
+		}
+		pxStats->ulHistogram[ uxBucket ]++;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetTickLatencyStats( PortLatencyStats_t *pxStats )
+	{
+	BaseType_t x;
+	UBaseType_t uxBucket, uxStatus;
+
+		memset( pxStats, 0, sizeof( *pxStats ) );
+
+		portDISABLE_ALL_INTERRUPTS( uxStatus );
+		for( x = 0; x < configNUMBER_OF_CORES; x++ )
+		{
+			if( xTickLatency[ x ].ulCount == 0 )
+			{
+				continue;
+			}
+			if( ( pxStats->ulCount == 0 ) || ( xTickLatency[ x ].ulMin < pxStats->ulMin ) )
+			{
+				pxStats->ulMin = xTickLatency[ x ].ulMin;
+			}
+			if( xTickLatency[ x ].ulMax > pxStats->ulMax )
+			{
+				pxStats->ulMax = xTickLatency[ x ].ulMax;
+			}
+			pxStats->ulCount += xTickLatency[ x ].ulCount;
+			pxStats->ullTotal += xTickLatency[ x ].ullTotal;
+			for( uxBucket = 0; uxBucket < portLATENCY_BUCKETS; uxBucket++ )
+			{
+				pxStats->ulHistogram[ uxBucket ] += xTickLatency[ x ].ulHistogram[ uxBucket ];
+			}
+		}
+		portRESTORE_ALL_INTERRUPTS( uxStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortResetTickLatencyStats( void )
+	{
+	UBaseType_t uxStatus;
+
+		portDISABLE_ALL_INTERRUPTS( uxStatus );
+		memset( xTickLatency, 0, sizeof( xTickLatency ) );
+		portRESTORE_ALL_INTERRUPTS( uxStatus );
+	}
+
+#endif /* configUSE_IRQ_LATENCY_STATS */
+/*-----------------------------------------------------------*/
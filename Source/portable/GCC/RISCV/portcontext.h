@@ -0,0 +1,271 @@
+/*
+    FreeRTOS V8.2.3 - Copyright (C) 2015 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution and was contributed
+    to the project by Technolution B.V. (www.technolution.nl,
+    freertos-riscv@technolution.eu) under the terms of the FreeRTOS
+    contributors license.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef PORTCONTEXT_H
+#define PORTCONTEXT_H
+
+/* The options below change the frame layout and the trap entry code, so the
+assembly files take them from FreeRTOSConfig.h as well.  The C only parts of
+FreeRTOSConfig.h must be guarded with #ifndef __ASSEMBLER__. */
+#include "FreeRTOSConfig.h"
+
+/*-----------------------------------------------------------
+ * Layout of the task context frame and the interrupt controller registers
+ * that the context switch code touches.
+ *
+ * This header is shared between portasm.S, arch/boot.S and port.c and must
+ * therefore only contain preprocessor definitions, apart from the assembler
+ * macros guarded by __ASSEMBLER__.
+ *
+ * The integer part of the frame holds x1 - x31 in slots 0 - 30 and the task
+ * program counter in slot 31.  When the toolchain targets the F or D extension
+ * the frame is extended by the mstatus.FS state of the task.  fcsr and f0 - f31
+ * do not live in the frame but in a save area that pxPortInitialiseStack()
+ * reserves directly below the TLS block of the task, so it is found at a fixed
+ * offset below tp and keeps its contents while the task runs.  The registers
+ * are only written to the save area when the FS state of the task is Dirty.
+ * Restoring a task that has used the FPU reloads them and sets FS to Clean, so
+ * a task that does not touch the FPU again before it is switched out is not
+ * saved again.  Tasks that never touch the FPU stay Initial and do not pay for
+ * the additional 33 loads and stores at all.  The external interrupt path does
+ * not save the FPU registers, so interrupt handlers must not use floating
+ * point.
+ *
+ * With the V extension the frame is extended once more by the mstatus.VS state
+ * of the task, and vstart, vl, vtype, vcsr and v0 - v31 follow the FPU
+ * registers in the save area with the same Dirty and Clean handling.  The save
+ * area reserves room for the minimum VLEN the toolchain targets and port.c
+ * checks that vlenb matches it.  Vector state is not preserved across calls, so
+ * a voluntary frame never holds it and the task resumes with its VS state
+ * Initial.  Interrupt handlers must not use vectors either, the routines in
+ * arch/memops.c fall back to scalar code while an interrupt handler runs.
+ *
+ * A task that yields through a call to vPortYield() only needs the registers
+ * the calling convention preserves across calls, so a voluntary frame only
+ * holds ra, tp, s0 - s11 in the same slots a full frame uses, and only
+ * fs0 - fs11 plus fcsr are written to the save area when the FPU is Dirty.
+ * sp is kept in the TCB and gp never changes, so the sp slot records which of
+ * the two formats was saved.  With the PMP stack guard the gp slot holds the
+ * guard address of the task.
+ *-----------------------------------------------------------
+ */
+
+#if __riscv_xlen == 64
+	#define portWORD_SIZE			8
+	#define portLOG_WORD_SIZE		3
+#else
+	#define portWORD_SIZE			4
+	#define portLOG_WORD_SIZE		2
+#endif
+
+/* The number of harts the scheduler runs tasks on.  The context switch code
+keeps one current TCB, interrupt nesting count and interrupt stack per hart,
+so the value has to be the same for the C and the assembly files.  Harts are
+expected to be numbered 0 to configNUMBER_OF_CORES - 1. */
+#ifndef configNUMBER_OF_CORES
+	#define configNUMBER_OF_CORES	1
+#endif
+
+#ifdef __ASSEMBLER__
+/* Per-hart state lives in arrays indexed by mhartid, or in a single variable
+when there is only one hart.  Loads the address of the entry of this hart into
+rd. */
+#if configNUMBER_OF_CORES > 1
+.macro portHART_ENTRY rd, tmp, array
+	csrr	\tmp, mhartid
+	slli	\tmp, \tmp, portLOG_WORD_SIZE
+	la		\rd, \array
+	add		\rd, \rd, \tmp
+	.endm
+#else
+.macro portHART_ENTRY rd, tmp, array
+	la		\rd, \array
+	.endm
+#endif
+#endif /* __ASSEMBLER__ */
+
+#define portFRAME_TYPE_OFFSET		( 1 * portWORD_SIZE )
+#define portSTACK_GUARD_OFFSET		( 2 * portWORD_SIZE )
+#define portPC_OFFSET				( 31 * portWORD_SIZE )
+#define portINTEGER_CONTEXT_SIZE	( 32 * portWORD_SIZE )
+
+/* Frame formats, see portFRAME_TYPE_OFFSET. */
+#define portFRAME_FULL				0
+#define portFRAME_VOLUNTARY			1
+
+/* Offsets ending in _STATUS_OFFSET are frame slots, the other FPU and vector
+offsets are relative to the start of the save area, which is
+portSAVE_AREA_SIZE bytes below tp. */
+#ifdef __riscv_flen
+	#define portFPU_WORD_SIZE		( __riscv_flen / 8 )
+	#define portFPU_STATUS_OFFSET	( 32 * portWORD_SIZE )
+	#define portFRAME_FPU_END		( 33 * portWORD_SIZE )
+	#define portFCSR_OFFSET			0
+	#define portFREGS_OFFSET		8
+	#define portFPU_AREA_END		( portFREGS_OFFSET + ( 32 * portFPU_WORD_SIZE ) )
+
+	/* mstatus.FS encodings. */
+	#define portMSTATUS_FS			0x6000
+	#define portMSTATUS_FS_INITIAL	0x2000
+	#define portMSTATUS_FS_CLEAN	0x4000
+	#define portMSTATUS_FS_DIRTY	0x6000
+#else
+	#define portFRAME_FPU_END		portINTEGER_CONTEXT_SIZE
+	#define portFPU_AREA_END		0
+#endif
+
+#ifdef __riscv_vector
+	#define portVLENB					( __riscv_v_min_vlen / 8 )
+	#define portVECTOR_STATUS_OFFSET	( portFRAME_FPU_END )
+	#define portCONTEXT_SIZE			( ( portFRAME_FPU_END + portWORD_SIZE + 15 ) & ~15 )
+	#define portVSTART_OFFSET			( portFPU_AREA_END )
+	#define portVL_OFFSET				( portFPU_AREA_END + ( 1 * portWORD_SIZE ) )
+	#define portVTYPE_OFFSET			( portFPU_AREA_END + ( 2 * portWORD_SIZE ) )
+	#define portVCSR_OFFSET				( portFPU_AREA_END + ( 3 * portWORD_SIZE ) )
+	#define portVREGS_OFFSET			( ( portFPU_AREA_END + ( 4 * portWORD_SIZE ) + 15 ) & ~15 )
+	#define portSAVE_AREA_SIZE			( ( portVREGS_OFFSET + ( 32 * portVLENB ) + 15 ) & ~15 )
+
+	/* mstatus.VS encodings. */
+	#define portMSTATUS_VS				0x600
+	#define portMSTATUS_VS_INITIAL		0x200
+	#define portMSTATUS_VS_CLEAN		0x400
+	#define portMSTATUS_VS_DIRTY		0x600
+#else
+	#define portCONTEXT_SIZE			( ( portFRAME_FPU_END + 15 ) & ~15 )
+	#define portSAVE_AREA_SIZE			( ( portFPU_AREA_END + 15 ) & ~15 )
+#endif
+
+/* The frame is allocated and released with a single addi. */
+#if portCONTEXT_SIZE > 2032
+	#error The context frame does not fit a 12-bit immediate
+#endif
+
+/* With configENABLE_PMP_STACK_GUARD set to 1 the lowest
+configPMP_STACK_GUARD_SIZE bytes of the stack of the running task are covered
+by a PMP region without any permissions.  Tasks run in machine mode with
+mstatus.MPRV set while mstatus.MPP reads user mode, which it does after every
+mret, so their loads and stores are checked against the PMP entries and a
+stack overflow faults on the first access to the guard.  Interrupt handlers
+are entered with MPP set to machine mode and are not checked.  The hart must
+implement user mode and at least three PMP entries.
+
+A trap stores a context frame, or the partial frame of the external interrupt
+entry in arch/boot.S, on the stack of the task it interrupts, unchecked.  The
+guard is as large as both together, so a task interrupted close to the end of
+its stack writes its frame into the guard rather than past it, and faults on
+its next access there. */
+#ifndef configENABLE_PMP_STACK_GUARD
+	#define configENABLE_PMP_STACK_GUARD	0
+#endif
+
+#define portMIN_STACK_GUARD_SIZE	( portCONTEXT_SIZE + portINTEGER_CONTEXT_SIZE )
+
+#ifndef configPMP_STACK_GUARD_SIZE
+	#define configPMP_STACK_GUARD_SIZE		portMIN_STACK_GUARD_SIZE
+#endif
+
+#if configPMP_STACK_GUARD_SIZE < portMIN_STACK_GUARD_SIZE
+	#error configPMP_STACK_GUARD_SIZE must hold a context frame and the frame of the external interrupt entry
+#endif
+
+/* With configUSE_IRQ_LATENCY_STATS set to 1 the port and arch/irq.c record
+how late the tick interrupt is served and how long external interrupts take
+from the trap to their handler and to the task they wake, see
+print_interrupt_latency() in arch/irq.h.  boot.S and portasm.S take time
+stamps for it. */
+#ifndef configUSE_IRQ_LATENCY_STATS
+	#define configUSE_IRQ_LATENCY_STATS		0
+#endif
+
+/* PMP entry 0 and 1 form the guard as a TOR region, entry 2 grants read and
+write access to all other memory as a NAPOT region. */
+#define portPMPCFG_STACK_GUARD		0x1b0800
+#define portMSTATUS_MPRV			0x20000
+#define portMSTATUS_MPP				0x1800
+
+/* Kernel critical sections mask the tick and the machine software interrupt
+in mie and raise the priority threshold of the PLIC context of the hart to
+configMAX_SYSCALL_INTERRUPT_PRIORITY, so external interrupts above that
+priority are never delayed by the kernel. */
+#define portMIE_MSIE				0x8
+#define portMIE_MTIE				0x80
+#define portMIE_KERNEL				( portMIE_MSIE | portMIE_MTIE )
+#define portPLIC_PRIORITY_ADDRESS	0x40000000
+#define portPLIC_THRESHOLD_ADDRESS	0x40200000
+#define portPLIC_CONTEXT_SHIFT		12	/* Hart contexts are 4KB apart. */
+
+/* Writing 1 to the msip register of a hart in the CLINT pends a machine
+software interrupt, which performs a deferred context switch on that hart. */
+#define portCLINT_MSIP_ADDRESS		0x2000000
+#define portCLINT_MSIP_SHIFT		2	/* One 32-bit register per hart. */
+
+#endif /* PORTCONTEXT_H */
@@ -78,6 +78,9 @@
 extern "C" {
 #endif
 
+/* Options shared with the assembly files, such as configNUMBER_OF_CORES. */
+#include "portcontext.h"
+
 /*-----------------------------------------------------------
  * Port specific definitions.
  *
@@ -108,45 +111,313 @@ typedef portSTACK_TYPE StackType_t;
 typedef long BaseType_t;
 typedef unsigned long UBaseType_t;
 
+/* With configUSE_64_BIT_TICKS set to 1 the tick count is as wide as mtime and
+never wraps in practice, so even a 10 kHz or faster tick needs no overflow
+handling in the application. */
+#ifndef configUSE_64_BIT_TICKS
+	#define configUSE_64_BIT_TICKS 0
+#endif
+
+#if( ( configUSE_16_BIT_TICKS == 1 ) && ( configUSE_64_BIT_TICKS == 1 ) )
+	#error configUSE_16_BIT_TICKS and configUSE_64_BIT_TICKS cannot both be set to 1
+#endif
+
 #if( configUSE_16_BIT_TICKS == 1 )
 	typedef uint16_t TickType_t;
 	#define portMAX_DELAY ( TickType_t ) 0xffff
+#elif( configUSE_64_BIT_TICKS == 1 )
+	typedef uint64_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffffffffffULL
 #else
 	typedef uint32_t TickType_t;
 	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
 #endif
+
+/* A tick count that fits in a register is read with a single load.  Only a
+64-bit tick on RV32 has to be read inside a critical section so the tick
+interrupt cannot update it between the two halves. */
+#if( ( configUSE_64_BIT_TICKS == 1 ) && ( __riscv_xlen == 32 ) )
+	#define portTICK_TYPE_IS_ATOMIC		0
+#else
+	#define portTICK_TYPE_IS_ATOMIC		1
+#endif
 /*-----------------------------------------------------------*/
 
 /* Architecture specifics. */
 #define portSTACK_GROWTH			( -1 )
 #define portTICK_PERIOD_MS			( ( TickType_t ) (1000 / configTICK_RATE_HZ) )
-#if __riscv_xlen == 64
-	#define portBYTE_ALIGNMENT	8
-#else
-	#define portBYTE_ALIGNMENT	4
-#endif
+/* The RISC-V psABI requires the stack pointer to be 16 byte aligned.  This
+also keeps the double precision slots of the FPU context frame naturally
+aligned on RV32. */
+#define portBYTE_ALIGNMENT	16
 #define portCRITICAL_NESTING_IN_TCB					1
 /*-----------------------------------------------------------*/
 
+/* Code and data that every tick and context switch touches go to the
+.fast_text and .fast_data sections, which link.ld places in the fast_imem and
+fast_dmem regions. */
+#define portFAST_CODE	__attribute__( ( section( ".fast_text" ) ) )
+#define portFAST_DATA	__attribute__( ( section( ".fast_data" ) ) )
+/*-----------------------------------------------------------*/
+
 
-/* Scheduler utilities. */
+/* Scheduler utilities.  A task outside of a critical section switches
+directly, otherwise and from interrupt handlers the switch is pended through
+the machine software interrupt and taken once the kernel interrupts are
+unmasked again. */
 extern void vPortYield( void );
-#define portYIELD()					vPortYield()
+extern void vPortYieldFromTask( void );
+extern void vPortPendYield( void );
+#define portYIELD()					vPortYieldFromTask()
+
+/* The number of interrupt handlers currently running on each hart, including
+nested ones.  Zero while a task is running. */
+#if( configNUMBER_OF_CORES > 1 )
+	extern volatile UBaseType_t uxPortInterruptNesting[ configNUMBER_OF_CORES ];
+	#define portIS_INSIDE_INTERRUPT()	( uxPortInterruptNesting[ portGET_CORE_ID() ] != 0 )
+#else
+	extern volatile UBaseType_t uxPortInterruptNesting;
+	#define portIS_INSIDE_INTERRUPT()	( uxPortInterruptNesting != 0 )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Multi-hart support.  Every hart runs the scheduler on its own tick and
+reschedules the other harts by pending their machine software interrupt.
+The kernel data is protected by two recursive spinlocks, the task lock is
+held while a task is inside a critical section and the ISR lock while any
+hart accesses the ready and event lists.  Suspending the scheduler takes
+neither, it only stops the calling hart from switching tasks.  External
+interrupts are only enabled on hart 0. */
+#if( configNUMBER_OF_CORES > 1 )
+
+	#ifndef __riscv_atomic
+		#error configNUMBER_OF_CORES > 1 requires the A extension for the kernel locks
+	#endif
+
+	#if( configUSE_TICKLESS_IDLE == 1 )
+		#error configUSE_TICKLESS_IDLE is not supported with more than one core
+	#endif
+
+	static inline BaseType_t xPortGetCoreID( void ) __attribute__( ( always_inline ) );
+	static inline BaseType_t xPortGetCoreID( void )
+	{
+	BaseType_t xHartID;
+
+		__asm volatile( "csrr %0, mhartid" : "=r"( xHartID ) );
+		return xHartID;
+	}
+
+	extern void vPortYieldCore( BaseType_t xCoreID );
+	extern void vPortGetTaskLock( void );
+	extern void vPortReleaseTaskLock( void );
+	extern void vPortGetISRLock( void );
+	extern void vPortReleaseISRLock( void );
+
+	#define portGET_CORE_ID()				xPortGetCoreID()
+	#define portYIELD_CORE( xCoreID )		vPortYieldCore( xCoreID )
+	#define portGET_TASK_LOCK()				vPortGetTaskLock()
+	#define portRELEASE_TASK_LOCK()			vPortReleaseTaskLock()
+	#define portGET_ISR_LOCK()				vPortGetISRLock()
+	#define portRELEASE_ISR_LOCK()			vPortReleaseISRLock()
+
+#else
+
+	#define portGET_CORE_ID()				0
+
+#endif /* configNUMBER_OF_CORES */
 /*-----------------------------------------------------------*/
 
 
 /* Critical section management. */
+
+/* Interrupt sources with a PLIC priority above this level are never masked by
+the kernel and must therefore not call any FreeRTOS API function.  The default
+is the highest priority of the PLIC, which masks all sources. */
+#ifndef configMAX_SYSCALL_INTERRUPT_PRIORITY
+	#define configMAX_SYSCALL_INTERRUPT_PRIORITY	7
+#endif
+
 extern int vPortSetInterruptMask( void );
 extern void vPortClearInterruptMask( int );
+#if( configNUMBER_OF_CORES > 1 )
+	extern int xPortSetInterruptMaskFromISR( void );
+	extern void vPortClearInterruptMaskFromISR( int );
+#endif
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
 extern void vTaskEnterCritical( void );
 extern void vTaskExitCritical( void );
 
-#define portDISABLE_INTERRUPTS()				__asm volatile 	( "csrc mstatus,8" )
-#define portENABLE_INTERRUPTS()					__asm volatile 	( "csrs mstatus,8" )
+#define portDISABLE_INTERRUPTS()				vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()					vPortEnableInterrupts()
 #define portENTER_CRITICAL()					vTaskEnterCritical()
 #define portEXIT_CRITICAL()						vTaskExitCritical()
-#define portSET_INTERRUPT_MASK_FROM_ISR()       vPortSetInterruptMask()
-#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue )       vPortClearInterruptMask( uxSavedStatusValue )
+#define portSET_INTERRUPT_MASK()				vPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK( uxSavedStatusValue )       vPortClearInterruptMask( uxSavedStatusValue )
+
+/* With more than one hart, the interrupt safe API also has to keep the other
+harts out of the kernel lists, so the ISR variants take the ISR lock. */
+#if( configNUMBER_OF_CORES > 1 )
+	#define portSET_INTERRUPT_MASK_FROM_ISR()       xPortSetInterruptMaskFromISR()
+	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue )       vPortClearInterruptMaskFromISR( uxSavedStatusValue )
+#else
+	#define portSET_INTERRUPT_MASK_FROM_ISR()       vPortSetInterruptMask()
+	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue )       vPortClearInterruptMask( uxSavedStatusValue )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Returns the raw 64-bit mtime value.  If pxTickCount is not NULL the tick
+count at the same instant is written to it, so a timestamp at mtime
+resolution can be related to the kernel time.  A tick that is due but not yet
+processed is not included in the tick count.  Can be called from tasks and
+interrupt handlers. */
+extern uint64_t ullPortGetTimeStamp( TickType_t *pxTickCount );
+/*-----------------------------------------------------------*/
+
+/* Run time statistics.  The run time counter is mcycle and the instruction
+counter minstret, both read as 64-bit values on RV32 as well.  The two clocks
+stop while an interrupt handler runs, the cycles and instructions of the tick
+and external interrupt handlers are accumulated per handler in PortISRStats_t
+instead of being charged to the interrupted task.  The context switch itself is
+still charged to the tasks. */
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+	#ifndef configRUN_TIME_COUNTER_TYPE
+		#define configRUN_TIME_COUNTER_TYPE		uint64_t
+	#endif
+
+	/* Accumulated cost of one interrupt source.  Nested handlers are included
+	in the cost of the handler they interrupted. */
+	typedef struct PORT_ISR_STATS
+	{
+		uint64_t ullCycles;
+		uint64_t ullInstructions;
+		uint32_t ulCount;
+	} PortISRStats_t;
+
+	/* Counter values at the start of a handler, see vPortISRStatsEnter(). */
+	typedef struct PORT_ISR_SAMPLE
+	{
+		uint64_t ullCycles;
+		uint64_t ullInstructions;
+	} PortISRSample_t;
+
+	/* Called with interrupts disabled at the start and at the end of an
+	interrupt handler, the cost of the handler is added to pxStats. */
+	extern void vPortISRStatsEnter( PortISRSample_t *pxSample );
+	extern void vPortISRStatsExit( const PortISRSample_t *pxSample, PortISRStats_t *pxStats );
+
+	/* Copies the statistics of the tick interrupt, summed over all harts. */
+	extern void vPortGetTickISRStats( PortISRStats_t *pxStats );
+
+	extern uint64_t ullPortGetRunTimeCounterValue( void );
+	extern uint64_t ullPortGetRunTimeInstructionCounterValue( void );
+
+	/* mcycle and minstret run from reset, nothing has to be set up. */
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+	#define portGET_RUN_TIME_COUNTER_VALUE()				ullPortGetRunTimeCounterValue()
+	#define portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE()	ullPortGetRunTimeInstructionCounterValue()
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+/* Interrupt latency statistics, see configUSE_IRQ_LATENCY_STATS in
+portcontext.h.  Latencies are in mcycle cycles.  Bucket 0 of the histogram
+counts latencies below 2 cycles, bucket n those from 2^n to 2^(n+1) - 1 and
+the last bucket everything above. */
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+
+	#define portLATENCY_BUCKETS		16
+
+	typedef struct PORT_LATENCY_STATS
+	{
+		uint32_t ulCount;
+		uint32_t ulMin;
+		uint32_t ulMax;
+		uint64_t ullTotal;		/* The average is ullTotal / ulCount. */
+		uint32_t ulHistogram[ portLATENCY_BUCKETS ];
+	} PortLatencyStats_t;
+
+	/* Adds one latency, called with interrupts disabled. */
+	extern void vPortLatencyRecord( PortLatencyStats_t *pxStats, uint32_t ulCycles );
+
+	/* Copies the time from mtimecmp to the entry of the tick handler, summed
+	over all harts.  mtime only has the resolution of configTICK_CLOCK_HZ. */
+	extern void vPortGetTickLatencyStats( PortLatencyStats_t *pxStats );
+
+	/* Clears the statistics of the tick. */
+	extern void vPortResetTickLatencyStats( void );
+
+#endif /* configUSE_IRQ_LATENCY_STATS */
+/*-----------------------------------------------------------*/
+
+/* Hardware stack overflow detection, see configENABLE_PMP_STACK_GUARD in
+portcontext.h.  A task that touches the guard at the end of its stack calls
+vApplicationStackOverflowHook() from the fault, so the pattern check of
+configCHECK_FOR_STACK_OVERFLOW is no longer needed. */
+#if( configENABLE_PMP_STACK_GUARD == 1 )
+	#define portHAS_STACK_OVERFLOW_CHECKING		1
+	#define portSTACK_GUARD_SIZE				configPMP_STACK_GUARD_SIZE
+#endif
+/*-----------------------------------------------------------*/
+
+/* Tickless idle/low power functionality. */
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specific optimisations. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 32 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	/* Count the leading zeros of a non zero 32-bit value.  With Zbb this is a
+	single clz instruction, otherwise a branch free binary search is used so
+	the cost does not depend on which priorities are ready. */
+	static inline uint32_t ulPortCountLeadingZeros( uint32_t ulBitmap ) __attribute__( ( always_inline ) );
+	static inline uint32_t ulPortCountLeadingZeros( uint32_t ulBitmap )
+	{
+	#ifdef __riscv_zbb
+		return ( uint32_t ) __builtin_clz( ulBitmap );
+	#else
+	uint32_t ulZeros, ulShift;
+
+		ulShift = ( uint32_t ) ( ulBitmap < 0x00010000UL ) << 4;
+		ulBitmap <<= ulShift;
+		ulZeros = ulShift;
+		ulShift = ( uint32_t ) ( ulBitmap < 0x01000000UL ) << 3;
+		ulBitmap <<= ulShift;
+		ulZeros += ulShift;
+		ulShift = ( uint32_t ) ( ulBitmap < 0x10000000UL ) << 2;
+		ulBitmap <<= ulShift;
+		ulZeros += ulShift;
+		ulShift = ( uint32_t ) ( ulBitmap < 0x40000000UL ) << 1;
+		ulBitmap <<= ulShift;
+		ulZeros += ulShift;
+		ulZeros += ( uint32_t ) ( ulBitmap < 0x80000000UL );
+
+		return ulZeros;
+	#endif
+	}
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/*-----------------------------------------------------------*/
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31UL - ( UBaseType_t ) ulPortCountLeadingZeros( ( uint32_t ) ( uxReadyPriorities ) ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 /*-----------------------------------------------------------*/
 
 /* Task function macros as described on the FreeRTOS.org WEB site. */
@@ -84,6 +84,7 @@ static uint8_t *pucAlignedHeap = NULL;
 	#endif
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		if( pucAlignedHeap == NULL )
 		{
@@ -103,6 +104,7 @@ static uint8_t *pucAlignedHeap = NULL;
 
 		traceMALLOC( pvReturn, xWantedSize );
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
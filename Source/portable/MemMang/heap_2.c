@@ -122,6 +122,7 @@ static BaseType_t xHeapHasBeenInitialised = pdFALSE;
 void *pvReturn = NULL;
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		/* If this is the first call to malloc then the heap will require
 		initialisation to setup the list of free blocks. */
@@ -191,6 +192,7 @@ void *pvReturn = NULL;
 
 		traceMALLOC( pvReturn, xWantedSize );
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -223,12 +225,14 @@ BlockLink_t *pxLink;
 		pxLink = ( void * ) puc;
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* Add this block to the list of free blocks. */
 			prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 			xFreeBytesRemaining += pxLink->xBlockSize;
 			traceFREE( pv, pxLink->xBlockSize );
 		}
+		taskEXIT_CRITICAL_SMP();
 		( void ) xTaskResumeAll();
 	}
 }
@@ -53,6 +53,13 @@ task.h is included from an application file. */
 	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
+/* vTaskSuspendAll() only holds off the calling core when configNUMBER_OF_CORES
+is greater than 1, and malloc() cannot be called inside a critical section
+instead, as it takes the malloc lock of the C library. */
+#if( configNUMBER_OF_CORES > 1 )
+	#error heap_3.c cannot be used with configNUMBER_OF_CORES greater than 1, use heap_4.c or heap_5.c
+#endif
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
@@ -116,6 +116,7 @@ BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
 void *pvReturn = NULL;
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		/* If this is the first call to malloc then the heap will require
 		initialisation to setup the list of free blocks. */
@@ -239,6 +240,7 @@ void *pvReturn = NULL;
 
 		traceMALLOC( pvReturn, xWantedSize );
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -287,12 +289,14 @@ BlockLink_t *pxLink;
 				pxLink->xBlockSize &= ~xBlockAllocatedBit;
 
 				vTaskSuspendAll();
+				taskENTER_CRITICAL_SMP();
 				{
 					/* Add this block to the list of free blocks. */
 					xFreeBytesRemaining += pxLink->xBlockSize;
 					traceFREE( pv, pxLink->xBlockSize );
 					prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 				}
+				taskEXIT_CRITICAL_SMP();
 				( void ) xTaskResumeAll();
 			}
 			else
@@ -139,6 +139,7 @@ void *pvReturn = NULL;
 	configASSERT( pxEnd );
 
 	vTaskSuspendAll();
+	taskENTER_CRITICAL_SMP();
 	{
 		/* Check the requested block size is not so large that the top bit is
 		set.  The top bit of the block size member of the BlockLink_t structure
@@ -249,6 +250,7 @@ void *pvReturn = NULL;
 
 		traceMALLOC( pvReturn, xWantedSize );
 	}
+	taskEXIT_CRITICAL_SMP();
 	( void ) xTaskResumeAll();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
@@ -296,12 +298,14 @@ BlockLink_t *pxLink;
 				pxLink->xBlockSize &= ~xBlockAllocatedBit;
 
 				vTaskSuspendAll();
+				taskENTER_CRITICAL_SMP();
 				{
 					/* Add this block to the list of free blocks. */
 					xFreeBytesRemaining += pxLink->xBlockSize;
 					traceFREE( pv, pxLink->xBlockSize );
 					prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 				}
+				taskEXIT_CRITICAL_SMP();
 				( void ) xTaskResumeAll();
 			}
 			else
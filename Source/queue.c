@@ -878,10 +878,16 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
+			/* With more than one core a task on another core can change the
+			queue while the scheduler is suspended here.  Checking the queue
+			and joining the event list in one critical section makes sure that
+			task either sees this one waiting or leaves the queue full. */
+			taskENTER_CRITICAL_SMP();
 			if( prvIsQueueFull( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				taskEXIT_CRITICAL_SMP();
 
 				/* Unlocking the queue means queue events can effect the
 				event list.  It is possible that interrupts occurring now
@@ -903,6 +909,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			else
 			{
 				/* Try again. */
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
 			}
@@ -1335,10 +1342,12 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		{
 			/* The timeout has not expired.  If the queue is still empty place
 			the task on the list of tasks waiting to receive from the queue. */
+			taskENTER_CRITICAL_SMP();
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -1353,6 +1362,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			{
 				/* The queue contains data again.  Loop back to try and read the
 				data. */
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
 			}
@@ -1509,6 +1519,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			count is 0 then enter the Blocked state to wait for a semaphore to
 			become available.  As semaphores are implemented with queues the
 			queue being empty is equivalent to the semaphore count being 0. */
+			taskENTER_CRITICAL_SMP();
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
@@ -1531,6 +1542,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 				#endif
 
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -1545,6 +1557,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			{
 				/* There was no timeout and the semaphore count was not 0, so
 				attempt to take the semaphore again. */
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
 			}
@@ -1704,10 +1717,12 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		{
 			/* Timeout has not expired yet, check to see if there is data in the
 			queue now, and if not enter the Blocked state to wait for data. */
+			taskENTER_CRITICAL_SMP();
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_PEEK( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -1722,6 +1737,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			{
 				/* There is data in the queue now, so don't enter the blocked
 				state, instead return to try and obtain the data. */
+				taskEXIT_CRITICAL_SMP();
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
 			}
@@ -2717,6 +2733,7 @@ BaseType_t xReturn;
 		the queue is locked, and the calling task blocks on the queue, then the
 		calling task will be immediately unblocked when the queue is unlocked. */
 		prvLockQueue( pxQueue );
+		taskENTER_CRITICAL_SMP();
 		if( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 0U )
 		{
 			/* There is nothing in the queue, block for the specified period. */
@@ -2726,6 +2743,7 @@ BaseType_t xReturn;
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		taskEXIT_CRITICAL_SMP();
 		prvUnlockQueue( pxQueue );
 	}
 
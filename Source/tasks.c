@@ -38,6 +38,7 @@ task.h is included from an application file. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "timers.h"
+#include "workqueue.h"
 #include "stack_macros.h"
 
 /* Lint e961 and e750 are suppressed as a MISRA exception justified because the
@@ -56,6 +57,11 @@ functions but without including stdio.h here. */
 	#include <stdio.h>
 #endif /* configUSE_STATS_FORMATTING_FUNCTIONS == 1 ) */
 
+#if( ( configNUMBER_OF_CORES > 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
+	/* The idle tasks of the further cores are created dynamically. */
+	#error configSUPPORT_DYNAMIC_ALLOCATION must be 1 when configNUMBER_OF_CORES is greater than 1
+#endif
+
 #if( configUSE_PREEMPTION == 0 )
 	/* If the cooperative scheduler is being used then a yield should not be
 	performed just because a higher priority task has been woken. */
@@ -210,6 +216,52 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/* Each core runs its own task, so a task that is made ready may have to
+	preempt another core than the calling one.  xTaskRunState holds the core a
+	task is running on. */
+	#define taskTASK_NOT_RUNNING			( ( BaseType_t ) -1 )
+	#define taskTASK_IS_RUNNING( pxTCB )	( ( pxTCB )->xTaskRunState != taskTASK_NOT_RUNNING )
+	#define taskYIELD_FOR_TASK( pxTCB )		prvYieldForTask( pxTCB )
+
+	/* Reschedule the core pxTCB is running on, if that is not the calling
+	core, after pxTCB has been blocked, suspended, deleted or lowered in
+	priority.  The calling core is handled by the existing yield logic. */
+	#define taskYIELD_CORE_RUNNING_TASK( pxTCB )											\
+	{																						\
+		BaseType_t xRunState = ( pxTCB )->xTaskRunState;									\
+																							\
+		if( ( xRunState != taskTASK_NOT_RUNNING ) && ( xRunState != portGET_CORE_ID() ) )	\
+		{																					\
+			portYIELD_CORE( xRunState );													\
+		}																					\
+	}
+
+	/* The suspend count is kept per core.  The critical section keeps the
+	calling task on its core while the count of that core is read. */
+	#if ( configASSERT_DEFINED == 1 )
+		#define taskASSERT_SCHEDULER_NOT_SUSPENDED()								\
+		{																			\
+			taskENTER_CRITICAL();													\
+			configASSERT( uxSchedulerSuspended == 0 );								\
+			taskEXIT_CRITICAL();													\
+		}
+	#else
+		#define taskASSERT_SCHEDULER_NOT_SUSPENDED()
+	#endif
+
+#else
+
+	#define taskTASK_IS_RUNNING( pxTCB )	( ( pxTCB ) == pxCurrentTCB )
+	#define taskYIELD_FOR_TASK( pxTCB )
+	#define taskYIELD_CORE_RUNNING_TASK( pxTCB )
+	#define taskASSERT_SCHEDULER_NOT_SUSPENDED()	configASSERT( uxSchedulerSuspended == 0 )
+
+#endif /* configNUMBER_OF_CORES */
+
+/*-----------------------------------------------------------*/
+
 /* pxDelayedTaskList and pxOverflowDelayedTaskList are switched when the tick
 count overflows. */
 #define taskSWITCH_DELAYED_LISTS()																	\
@@ -230,13 +282,15 @@ count overflows. */
 
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
- * the task.  It is inserted at the end of the list.
+ * the task.  It is inserted at the end of the list.  With more than one core
+ * another core is rescheduled if the task should preempt it.
  */
 #define prvAddTaskToReadyList( pxTCB )																\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
 	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
 	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
-	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
+	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB );													\
+	taskYIELD_FOR_TASK( pxTCB )
 /*-----------------------------------------------------------*/
 
 /*
@@ -307,7 +361,10 @@ typedef struct tskTaskControlBlock
 	#endif
 
 	#if( configGENERATE_RUN_TIME_STATS == 1 )
-		uint32_t		ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
+		configRUN_TIME_COUNTER_TYPE	ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
+		#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+			configRUN_TIME_COUNTER_TYPE	ulRunTimeInstructionCounter;	/*< Stores the number of instructions the task has executed. */
+		#endif
 	#endif
 
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
@@ -336,6 +393,11 @@ typedef struct tskTaskControlBlock
 		uint8_t ucDelayAborted;
 	#endif
 
+	#if ( configNUMBER_OF_CORES > 1 )
+		volatile BaseType_t	xTaskRunState;		/*< The core the task is running on, or taskTASK_NOT_RUNNING. */
+		UBaseType_t		uxCoreAffinityMask;		/*< Bit n is set if the task may run on core n. */
+	#endif
+
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -345,10 +407,22 @@ typedef tskTCB TCB_t;
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/* The task running on each core.  A task can move to another core each
+	time it is switched out, so pxCurrentTCB reads the entry of the calling
+	core with interrupts masked. */
+	PRIVILEGED_DATA portFAST_DATA TCB_t * volatile pxCurrentTCBs[ configNUMBER_OF_CORES ] = { NULL };
+	#define pxCurrentTCB	( ( TCB_t * ) xTaskGetCurrentTaskHandle() )
+
+#else
+
+	PRIVILEGED_DATA portFAST_DATA TCB_t * volatile pxCurrentTCB = NULL;
+
+#endif
 
 /* Lists for ready and blocked tasks. --------------------*/
-PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ];/*< Prioritised ready tasks. */
+PRIVILEGED_DATA portFAST_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ];/*< Prioritised ready tasks. */
 PRIVILEGED_DATA static List_t xDelayedTaskList1;						/*< Delayed tasks. */
 PRIVILEGED_DATA static List_t xDelayedTaskList2;						/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;				/*< Points to the delayed task list currently being used. */
@@ -371,10 +445,15 @@ PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been r
 /* Other file private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) configINITIAL_TICK_COUNT;
-PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
+PRIVILEGED_DATA portFAST_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
+#if ( configNUMBER_OF_CORES > 1 )
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPendings[ configNUMBER_OF_CORES ] = { pdFALSE };
+	#define xYieldPending	xYieldPendings[ portGET_CORE_ID() ]
+#else
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPending 		= pdFALSE;
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
 PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
@@ -387,13 +466,35 @@ If an interrupt needs to unblock a task while the scheduler is suspended then it
 moves the task's event list item into the xPendingReadyList, ready for the
 kernel to move the task from the pending ready list into the real ready list
 when the scheduler is unsuspended.  The pending ready list itself can only be
-accessed from a critical section. */
-PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t ) pdFALSE;
+accessed from a critical section.
+
+With more than one core each core has its own count and only stops switching
+tasks on itself.  A task that suspended the scheduler cannot move to another
+core, so it always reads back its own count.  Other code reads it with
+interrupts masked. */
+#if ( configNUMBER_OF_CORES > 1 )
+	PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspendeds[ configNUMBER_OF_CORES ] = { ( UBaseType_t ) pdFALSE };
+	#define uxSchedulerSuspended	uxSchedulerSuspendeds[ portGET_CORE_ID() ]
+#else
+	PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t ) pdFALSE;
+#endif
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
-	PRIVILEGED_DATA static uint32_t ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
+	#if ( configNUMBER_OF_CORES > 1 )
+		PRIVILEGED_DATA static configRUN_TIME_COUNTER_TYPE ulTaskSwitchedInTime[ configNUMBER_OF_CORES ] = { 0UL };	/*< Holds the value of a timer/counter the last time a task was switched in on each core. */
+	#else
+		PRIVILEGED_DATA static configRUN_TIME_COUNTER_TYPE ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	#endif
+	PRIVILEGED_DATA static configRUN_TIME_COUNTER_TYPE ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
+
+	#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+		#if ( configNUMBER_OF_CORES > 1 )
+			PRIVILEGED_DATA static configRUN_TIME_COUNTER_TYPE ulTaskSwitchedInInstructions[ configNUMBER_OF_CORES ] = { 0UL };	/*< Holds the instruction counter the last time a task was switched in on each core. */
+		#else
+			PRIVILEGED_DATA static configRUN_TIME_COUNTER_TYPE ulTaskSwitchedInInstructions = 0UL;	/*< Holds the instruction counter the last time a task was switched in. */
+		#endif
+	#endif
 
 #endif
 
@@ -534,6 +635,24 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseT
  */
 static void prvResetNextTaskUnblockTime( void );
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/*
+	 * Select the task xCoreID runs next: the highest priority ready task that
+	 * is not running on another core and is allowed to run on xCoreID.  Tasks
+	 * of equal priority are taken in turn.
+	 */
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Called when pxTCB has been added to a ready list.  If pxTCB should
+	 * preempt the task running on another core, that core is rescheduled.
+	 * Preempting the calling core is left to the caller, as with one core.
+	 */
+	static void prvYieldForTask( TCB_t *pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	/*
@@ -544,6 +663,16 @@ static void prvResetNextTaskUnblockTime( void );
 
 #endif
 
+#if ( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+	/*
+	 * Helper function used to print a run time counter after a separator in
+	 * the table of vTaskGetRunTimeStats().
+	 */
+	static char *prvWriteCounterToBuffer( char *pcBuffer, const char *pcSeparator, configRUN_TIME_COUNTER_TYPE ulCounter ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Called after a Task_t structure has been allocated either statically or
  * dynamically to fill in the structure's members.
@@ -954,6 +1083,11 @@ UBaseType_t x;
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxNewTCB->ulRunTimeCounter = 0UL;
+		#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+		{
+			pxNewTCB->ulRunTimeInstructionCounter = 0UL;
+		}
+		#endif
 	}
 	#endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -997,6 +1131,13 @@ UBaseType_t x;
 	}
 	#endif
 
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		pxNewTCB->xTaskRunState = taskTASK_NOT_RUNNING;
+		pxNewTCB->uxCoreAffinityMask = tskNO_AFFINITY;
+	}
+	#endif
+
 	/* Initialize the TCB stack to look as if the task was already running,
 	but had been interrupted by the scheduler.  The return address is set
 	to the start of the task function. Once the stack has been initialised
@@ -1005,6 +1146,19 @@ UBaseType_t x;
 	{
 		pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters, xRunPrivileged );
 	}
+	#elif( portHAS_STACK_OVERFLOW_CHECKING == 1 )
+	{
+		/* The port guards the end of the stack itself. */
+		#if( portSTACK_GROWTH < 0 )
+		{
+			pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxNewTCB->pxStack, pxTaskCode, pvParameters );
+		}
+		#else /* portSTACK_GROWTH */
+		{
+			pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxNewTCB->pxEndOfStack, pxTaskCode, pvParameters );
+		}
+		#endif /* portSTACK_GROWTH */
+	}
 	#else /* portUSING_MPU_WRAPPERS */
 	{
 		pxNewTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pvParameters );
@@ -1031,6 +1185,21 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	taskENTER_CRITICAL();
 	{
 		uxCurrentNumberOfTasks++;
+
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			/* The task each core starts with is selected when the scheduler
+			is started. */
+			if( uxCurrentNumberOfTasks == ( UBaseType_t ) 1 )
+			{
+				prvInitialiseTaskLists();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
 		if( pxCurrentTCB == NULL )
 		{
 			/* There are no other tasks, or all the other tasks are in
@@ -1070,6 +1239,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		#endif /* configNUMBER_OF_CORES */
 
 		uxTaskNumber++;
 
@@ -1145,7 +1315,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			not return. */
 			uxTaskNumber++;
 
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) )
 			{
 				/* A task is deleting itself.  This cannot complete within the
 				task itself, as a context switch to another task is required.
@@ -1165,6 +1335,10 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				hence xYieldPending is used to latch that a context switch is
 				required. */
 				portPRE_TASK_DELETE_HOOK( pxTCB, &xYieldPending );
+
+				/* The task may also be running on another core, which then
+				has to switch away from it before it can be freed. */
+				taskYIELD_CORE_RUNNING_TASK( pxTCB );
 			}
 			else
 			{
@@ -1186,7 +1360,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		{
 			if( pxTCB == pxCurrentTCB )
 			{
-				configASSERT( uxSchedulerSuspended == 0 );
+				taskASSERT_SCHEDULER_NOT_SUSPENDED();
 				portYIELD_WITHIN_API();
 			}
 			else
@@ -1208,9 +1382,10 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		configASSERT( pxPreviousWakeTime );
 		configASSERT( ( xTimeIncrement > 0U ) );
-		configASSERT( uxSchedulerSuspended == 0 );
+		taskASSERT_SCHEDULER_NOT_SUSPENDED();
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* Minor optimisation.  The tick count cannot change in this
 			block. */
@@ -1266,6 +1441,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		taskEXIT_CRITICAL_SMP();
 		xAlreadyYielded = xTaskResumeAll();
 
 		/* Force a reschedule if xTaskResumeAll has not already done so, we may
@@ -1292,8 +1468,9 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		/* A delay time of zero just forces a reschedule. */
 		if( xTicksToDelay > ( TickType_t ) 0U )
 		{
-			configASSERT( uxSchedulerSuspended == 0 );
+			taskASSERT_SCHEDULER_NOT_SUSPENDED();
 			vTaskSuspendAll();
+			taskENTER_CRITICAL_SMP();
 			{
 				traceTASK_DELAY();
 
@@ -1306,6 +1483,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				executing task. */
 				prvAddCurrentTaskToDelayedList( xTicksToDelay, pdFALSE );
 			}
+			taskEXIT_CRITICAL_SMP();
 			xAlreadyYielded = xTaskResumeAll();
 		}
 		else
@@ -1338,9 +1516,10 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		configASSERT( pxTCB );
 
-		if( pxTCB == pxCurrentTCB )
+		if( taskTASK_IS_RUNNING( pxTCB ) )
 		{
-			/* The task calling this function is querying its own state. */
+			/* The task calling this function is querying its own state, or
+			that of a task running on another core. */
 			eReturn = eRunning;
 		}
 		else
@@ -1537,7 +1716,9 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				{
 					/* Setting the priority of any other task down does not
 					require a yield as the running task must be above the
-					new priority of the task being modified. */
+					new priority of the task being modified.  That does not
+					hold for a task running on another core. */
+					taskYIELD_CORE_RUNNING_TASK( pxTCB );
 				}
 
 				/* Remember the ready list the task might be referenced from
@@ -1625,6 +1806,86 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 #endif /* INCLUDE_vTaskPrioritySet */
 /*-----------------------------------------------------------*/
 
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+
+	void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask )
+	{
+	TCB_t *pxTCB;
+	BaseType_t xYieldRequired = pdFALSE;
+
+		configASSERT( ( uxCoreAffinityMask & ( ( ( UBaseType_t ) 1U << configNUMBER_OF_CORES ) - 1U ) ) != 0U );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+
+			if( taskTASK_IS_RUNNING( pxTCB ) )
+			{
+				/* Move the task off a core it may no longer run on.  On the
+				calling core the switch is pended until the critical section
+				is left. */
+				if( ( uxCoreAffinityMask & ( ( UBaseType_t ) 1U << pxTCB->xTaskRunState ) ) == 0U )
+				{
+					portYIELD_CORE( pxTCB->xTaskRunState );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+			{
+				/* The task may now be allowed on a core running a lower
+				priority task. */
+				prvYieldForTask( pxTCB );
+
+				if( ( ( uxCoreAffinityMask & ( ( UBaseType_t ) 1U << portGET_CORE_ID() ) ) != 0U ) &&
+					( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) )
+				{
+					xYieldRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xYieldRequired != pdFALSE )
+		{
+			taskYIELD_IF_USING_PREEMPTION();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+	UBaseType_t uxCoreAffinityMask;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			uxCoreAffinityMask = pxTCB->uxCoreAffinityMask;
+		}
+		taskEXIT_CRITICAL();
+
+		return uxCoreAffinityMask;
+	}
+
+#endif /* ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) ) */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskSuspend == 1 )
 
 	void vTaskSuspend( TaskHandle_t xTaskToSuspend )
@@ -1672,6 +1933,8 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				}
 			}
 			#endif
+
+			taskYIELD_CORE_RUNNING_TASK( pxTCB );
 		}
 		taskEXIT_CRITICAL();
 
@@ -1690,12 +1953,26 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			/* Before the scheduler is started no core has a current task. */
+			if( ( xSchedulerRunning != pdFALSE ) && ( pxTCB == pxCurrentTCB ) )
+			{
+				taskASSERT_SCHEDULER_NOT_SUSPENDED();
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
 		if( pxTCB == pxCurrentTCB )
 		{
 			if( xSchedulerRunning != pdFALSE )
 			{
 				/* The current task has just been suspended. */
-				configASSERT( uxSchedulerSuspended == 0 );
+				taskASSERT_SCHEDULER_NOT_SUSPENDED();
 				portYIELD_WITHIN_API();
 			}
 			else
@@ -1721,6 +1998,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		#endif /* configNUMBER_OF_CORES */
 	}
 
 #endif /* INCLUDE_vTaskSuspend */
@@ -1941,6 +2219,47 @@ BaseType_t xReturn;
 	}
 	#endif /* configSUPPORT_STATIC_ALLOCATION */
 
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+	BaseType_t xCoreID, xValue;
+	UBaseType_t x, uxDigits;
+	char cIdleName[ configMAX_TASK_NAME_LEN ];
+	const char * const pcIdleName = configIDLE_TASK_NAME;
+
+		/* Every core needs a task it can always run, so an idle task is added
+		for each further core.  They are called IDLE1, IDLE2, ... */
+		for( xCoreID = 1; ( xCoreID < configNUMBER_OF_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+		{
+			/* The core ID is appended in decimal, the name is shortened if
+			there is not enough room for all of its digits. */
+			uxDigits = 1;
+			for( xValue = xCoreID; xValue >= 10; xValue /= 10 )
+			{
+				uxDigits++;
+			}
+
+			for( x = 0; ( ( x + uxDigits ) < ( UBaseType_t ) ( configMAX_TASK_NAME_LEN - 1 ) ) && ( pcIdleName[ x ] != 0x00 ); x++ )
+			{
+				cIdleName[ x ] = pcIdleName[ x ];
+			}
+
+			cIdleName[ x + uxDigits ] = 0x00;
+			for( xValue = xCoreID; uxDigits > ( UBaseType_t ) 0; xValue /= 10 )
+			{
+				uxDigits--;
+				cIdleName[ x + uxDigits ] = ( char ) ( '0' + ( xValue % 10 ) );
+			}
+
+			xReturn = xTaskCreate(	prvIdleTask,
+									cIdleName,
+									configMINIMAL_STACK_SIZE,
+									( void * ) NULL,
+									( tskIDLE_PRIORITY | portPRIVILEGE_BIT ),
+									NULL );
+		}
+	}
+	#endif /* configNUMBER_OF_CORES */
+
 	#if ( configUSE_TIMERS == 1 )
 	{
 		if( xReturn == pdPASS )
@@ -1954,6 +2273,19 @@ BaseType_t xReturn;
 	}
 	#endif /* configUSE_TIMERS */
 
+	#if ( configUSE_WORK_QUEUES == 1 )
+	{
+		if( xReturn == pdPASS )
+		{
+			xReturn = xWorkQueueCreateWorkers();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_WORK_QUEUES */
+
 	if( xReturn == pdPASS )
 	{
 		/* freertos_tasks_c_additions_init() should only be called if the user
@@ -1972,6 +2304,19 @@ BaseType_t xReturn;
 		starts to run. */
 		portDISABLE_INTERRUPTS();
 
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+		BaseType_t xCoreID;
+
+			/* Hand out the highest priority tasks created so far, one to
+			each core. */
+			for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+			{
+				prvSelectHighestPriorityTask( xCoreID );
+			}
+		}
+		#endif /* configNUMBER_OF_CORES */
+
 		#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		{
 			/* Switch Newlib's _impure_ptr variable to point to the _reent
@@ -2031,11 +2376,27 @@ void vTaskEndScheduler( void )
 
 void vTaskSuspendAll( void )
 {
-	/* A critical section is not required as the variable is of type
-	BaseType_t.  Please read Richard Barry's reply in the following link to a
-	post in the FreeRTOS support forum before reporting this as a bug! -
-	http://goo.gl/wu4acr */
-	++uxSchedulerSuspended;
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		/* Only this core stops switching tasks, the other cores keep running
+		theirs.  Interrupts are masked so the task cannot move to another core
+		between reading the core ID and incrementing the count.  Once the count
+		is non zero it stays on this core until xTaskResumeAll(). */
+		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK();
+		++uxSchedulerSuspended;
+		portCLEAR_INTERRUPT_MASK( uxSavedInterruptStatus );
+	}
+	#else
+	{
+		/* A critical section is not required as the variable is of type
+		BaseType_t.  Please read Richard Barry's reply in the following link to a
+		post in the FreeRTOS support forum before reporting this as a bug! -
+		http://goo.gl/wu4acr */
+		++uxSchedulerSuspended;
+	}
+	#endif /* configNUMBER_OF_CORES */
 }
 /*----------------------------------------------------------*/
 
@@ -2350,6 +2711,7 @@ TCB_t *pxTCB;
 		configASSERT( strlen( pcNameToQuery ) < configMAX_TASK_NAME_LEN );
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* Search the ready lists. */
 			do
@@ -2396,6 +2758,7 @@ TCB_t *pxTCB;
 			}
 			#endif
 		}
+		taskEXIT_CRITICAL_SMP();
 		( void ) xTaskResumeAll();
 
 		return ( TaskHandle_t ) pxTCB;
@@ -2406,11 +2769,12 @@ TCB_t *pxTCB;
 
 #if ( configUSE_TRACE_FACILITY == 1 )
 
-	UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime )
+	UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, configRUN_TIME_COUNTER_TYPE * const pulTotalRunTime )
 	{
 	UBaseType_t uxTask = 0, uxQueue = configMAX_PRIORITIES;
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* Is there a space in the array for each task in the system? */
 			if( uxArraySize >= uxCurrentNumberOfTasks )
@@ -2470,6 +2834,7 @@ TCB_t *pxTCB;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		taskEXIT_CRITICAL_SMP();
 		( void ) xTaskResumeAll();
 
 		return uxTask;
@@ -2520,6 +2885,7 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 		configASSERT( pxTCB );
 
 		vTaskSuspendAll();
+		taskENTER_CRITICAL_SMP();
 		{
 			/* A task can only be prematurely removed from the Blocked state if
 			it is actually in the Blocked state. */
@@ -2578,6 +2944,7 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 				xReturn = pdFAIL;
 			}
 		}
+		taskEXIT_CRITICAL_SMP();
 		( void ) xTaskResumeAll();
 
 		return xReturn;
@@ -2586,7 +2953,7 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 #endif /* INCLUDE_xTaskAbortDelay */
 /*----------------------------------------------------------*/
 
-BaseType_t xTaskIncrementTick( void )
+portFAST_CODE BaseType_t xTaskIncrementTick( void )
 {
 TCB_t * pxTCB;
 TickType_t xItemValue;
@@ -2595,6 +2962,14 @@ BaseType_t xSwitchRequired = pdFALSE;
 	/* Called by the portable layer each time a tick interrupt occurs.
 	Increments the tick then checks to see if the new tick value will cause any
 	tasks to be unblocked. */
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		/* Interrupts are already masked, but the other cores have to be kept
+		out of the lists. */
+		portGET_ISR_LOCK();
+	}
+	#endif
+
 	traceTASK_INCREMENT_TICK( xTickCount );
 	if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
 	{
@@ -2754,6 +3129,12 @@ BaseType_t xSwitchRequired = pdFALSE;
 	}
 	#endif /* configUSE_PREEMPTION */
 
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		portRELEASE_ISR_LOCK();
+	}
+	#endif
+
 	return xSwitchRequired;
 }
 /*-----------------------------------------------------------*/
@@ -2848,7 +3229,81 @@ BaseType_t xSwitchRequired = pdFALSE;
 #endif /* configUSE_APPLICATION_TASK_TAG */
 /*-----------------------------------------------------------*/
 
-void vTaskSwitchContext( void )
+#if ( configNUMBER_OF_CORES > 1 )
+
+portFAST_CODE void vTaskSwitchContext( void )
+{
+const BaseType_t xCoreID = portGET_CORE_ID();
+
+	/* Called with interrupts masked.  The locks keep the other cores out of
+	the ready lists while the next task is selected. */
+	portGET_TASK_LOCK();
+	portGET_ISR_LOCK();
+
+	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
+	{
+		/* The scheduler is suspended by the task running on this core - do not
+		allow a context switch. */
+		xYieldPendings[ xCoreID ] = pdTRUE;
+	}
+	else
+	{
+		xYieldPendings[ xCoreID ] = pdFALSE;
+		traceTASK_SWITCHED_OUT();
+
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+				#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+					portALT_GET_RUN_TIME_COUNTER_VALUE( ulTotalRunTime );
+				#else
+					ulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+				#endif
+
+				if( ulTotalRunTime > ulTaskSwitchedInTime[ xCoreID ] )
+				{
+					pxCurrentTCBs[ xCoreID ]->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime[ xCoreID ] );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				ulTaskSwitchedInTime[ xCoreID ] = ulTotalRunTime;
+
+				#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+				{
+				const configRUN_TIME_COUNTER_TYPE ulInstructions = portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE();
+
+					pxCurrentTCBs[ xCoreID ]->ulRunTimeInstructionCounter += ( ulInstructions - ulTaskSwitchedInInstructions[ xCoreID ] );
+					ulTaskSwitchedInInstructions[ xCoreID ] = ulInstructions;
+				}
+				#endif
+		}
+		#endif /* configGENERATE_RUN_TIME_STATS */
+
+		/* Check for stack overflow, if configured. */
+		taskCHECK_FOR_STACK_OVERFLOW();
+
+		/* The task that was running is free to be picked up by any core again
+		once the locks are released, its context has already been saved. */
+		prvSelectHighestPriorityTask( xCoreID );
+		traceTASK_SWITCHED_IN();
+
+		#if ( configUSE_NEWLIB_REENTRANT == 1 )
+		{
+			/* Switch Newlib's _impure_ptr variable to point to the _reent
+			structure specific to this task. */
+			_impure_ptr = &( pxCurrentTCBs[ xCoreID ]->xNewLib_reent );
+		}
+		#endif /* configUSE_NEWLIB_REENTRANT */
+	}
+
+	portRELEASE_ISR_LOCK();
+	portRELEASE_TASK_LOCK();
+}
+
+#else /* configNUMBER_OF_CORES */
+
+portFAST_CODE void vTaskSwitchContext( void )
 {
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
@@ -2885,6 +3340,17 @@ void vTaskSwitchContext( void )
 					mtCOVERAGE_TEST_MARKER();
 				}
 				ulTaskSwitchedInTime = ulTotalRunTime;
+
+				/* The instruction counter is only ever provided by the port,
+				so it is trusted to count up. */
+				#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+				{
+				const configRUN_TIME_COUNTER_TYPE ulInstructions = portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE();
+
+					pxCurrentTCB->ulRunTimeInstructionCounter += ( ulInstructions - ulTaskSwitchedInInstructions );
+					ulTaskSwitchedInInstructions = ulInstructions;
+				}
+				#endif
 		}
 		#endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -2905,8 +3371,145 @@ void vTaskSwitchContext( void )
 		#endif /* configUSE_NEWLIB_REENTRANT */
 	}
 }
+
+#endif /* configNUMBER_OF_CORES */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
+	{
+	UBaseType_t uxPriority, uxCount;
+	List_t *pxList;
+	ListItem_t *pxItem;
+	TCB_t *pxTCB, *pxSelected = NULL;
+
+		if( pxCurrentTCBs[ xCoreID ] != NULL )
+		{
+			pxCurrentTCBs[ xCoreID ]->xTaskRunState = taskTASK_NOT_RUNNING;
+		}
+
+		/* Find the highest priority list that contains ready tasks. */
+		#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+		{
+			while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
+			{
+				configASSERT( uxTopReadyPriority );
+				--uxTopReadyPriority;
+			}
+			uxPriority = uxTopReadyPriority;
+		}
+		#else
+		{
+			portGET_HIGHEST_PRIORITY( uxPriority, uxTopReadyPriority );
+		}
+		#endif
+
+		for( ;; )
+		{
+			/* Walk the list from the entry after the one last selected, as
+			listGET_OWNER_OF_NEXT_ENTRY() does, so tasks of the same priority
+			get an equal share of the cores. */
+			pxList = &( pxReadyTasksLists[ uxPriority ] );
+			pxItem = pxList->pxIndex;
+
+			for( uxCount = listCURRENT_LIST_LENGTH( pxList ); uxCount > ( UBaseType_t ) 0; uxCount-- )
+			{
+				pxItem = pxItem->pxNext;
+				if( ( void * ) pxItem == ( void * ) &( pxList->xListEnd ) )
+				{
+					pxItem = pxItem->pxNext;
+				}
+
+				pxTCB = ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+				if( taskTASK_IS_RUNNING( pxTCB ) )
+				{
+					continue;
+				}
+
+				#if ( configUSE_CORE_AFFINITY == 1 )
+				{
+					if( ( pxTCB->uxCoreAffinityMask & ( ( UBaseType_t ) 1U << xCoreID ) ) == 0U )
+					{
+						continue;
+					}
+				}
+				#endif
+
+				pxList->pxIndex = pxItem;
+				pxSelected = pxTCB;
+				break;
+			}
+
+			if( pxSelected != NULL )
+			{
+				break;
+			}
+
+			/* There is an idle task for every core, so a task is always left
+			at the idle priority. */
+			configASSERT( uxPriority > tskIDLE_PRIORITY );
+			uxPriority--;
+		}
+
+		pxSelected->xTaskRunState = xCoreID;
+		pxCurrentTCBs[ xCoreID ] = pxSelected;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvYieldForTask( TCB_t *pxTCB )
+	{
+	#if ( configUSE_PREEMPTION == 1 )
+		const BaseType_t xThisCore = portGET_CORE_ID();
+		BaseType_t xCoreID, xLowestCore = taskTASK_NOT_RUNNING;
+		UBaseType_t uxLowestPriority = pxTCB->uxPriority;
+		UBaseType_t uxAllowedCores = tskNO_AFFINITY;
+
+		if( ( xSchedulerRunning == pdFALSE ) || taskTASK_IS_RUNNING( pxTCB ) )
+		{
+			return;
+		}
+
+		#if ( configUSE_CORE_AFFINITY == 1 )
+		{
+			uxAllowedCores = pxTCB->uxCoreAffinityMask;
+		}
+		#endif
+
+		/* The caller yields the calling core if the task has a higher
+		priority than the task running on it. */
+		if( ( ( uxAllowedCores & ( ( UBaseType_t ) 1U << xThisCore ) ) != 0U ) &&
+			( pxCurrentTCBs[ xThisCore ]->uxPriority < pxTCB->uxPriority ) )
+		{
+			return;
+		}
+
+		/* Otherwise preempt the core running the lowest priority task below
+		the priority of the task. */
+		for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+		{
+			if( ( xCoreID != xThisCore ) &&
+				( ( uxAllowedCores & ( ( UBaseType_t ) 1U << xCoreID ) ) != 0U ) &&
+				( pxCurrentTCBs[ xCoreID ]->uxPriority < uxLowestPriority ) )
+			{
+				uxLowestPriority = pxCurrentTCBs[ xCoreID ]->uxPriority;
+				xLowestCore = xCoreID;
+			}
+		}
+
+		if( xLowestCore != taskTASK_NOT_RUNNING )
+		{
+			portYIELD_CORE( xLowestCore );
+		}
+	#else
+		( void ) pxTCB;
+	#endif /* configUSE_PREEMPTION */
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configNUMBER_OF_CORES */
+
 void vTaskPlaceOnEventList( List_t * const pxEventList, const TickType_t xTicksToWait )
 {
 	configASSERT( pxEventList );
@@ -3259,9 +3862,10 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 
 			A critical region is not required here as we are just reading from
 			the list, and an occasional incorrect value will not matter.  If
-			the ready list at the idle priority contains more than one task
-			then a task other than the idle task is ready to execute. */
-			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) 1 )
+			the ready list at the idle priority contains more tasks than there
+			are idle tasks then a task other than an idle task is ready to
+			execute. */
+			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
 			{
 				taskYIELD();
 			}
@@ -3481,12 +4085,32 @@ static void prvCheckTasksWaitingTermination( void )
 			taskENTER_CRITICAL();
 			{
 				pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) );
-				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
-				--uxCurrentNumberOfTasks;
-				--uxDeletedTasksWaitingCleanUp;
+
+				#if ( configNUMBER_OF_CORES > 1 )
+				{
+					/* A task deleted while running on another core is only
+					freed once that core has switched away from it. */
+					if( taskTASK_IS_RUNNING( pxTCB ) )
+					{
+						pxTCB = NULL;
+					}
+				}
+				#endif
+
+				if( pxTCB != NULL )
+				{
+					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+					--uxCurrentNumberOfTasks;
+					--uxDeletedTasksWaitingCleanUp;
+				}
 			}
 			taskEXIT_CRITICAL();
 
+			if( pxTCB == NULL )
+			{
+				break;
+			}
+
 			prvDeleteTCB( pxTCB );
 		}
 	}
@@ -3522,10 +4146,20 @@ static void prvCheckTasksWaitingTermination( void )
 		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
 			pxTaskStatus->ulRunTimeCounter = pxTCB->ulRunTimeCounter;
+			#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+			{
+				pxTaskStatus->ulRunTimeInstructionCounter = pxTCB->ulRunTimeInstructionCounter;
+			}
+			#else
+			{
+				pxTaskStatus->ulRunTimeInstructionCounter = 0;
+			}
+			#endif
 		}
 		#else
 		{
 			pxTaskStatus->ulRunTimeCounter = 0;
+			pxTaskStatus->ulRunTimeInstructionCounter = 0;
 		}
 		#endif
 
@@ -3534,7 +4168,7 @@ static void prvCheckTasksWaitingTermination( void )
 		state is just set to whatever is passed in. */
 		if( eState != eInvalid )
 		{
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) )
 			{
 				pxTaskStatus->eCurrentState = eRunning;
 			}
@@ -3550,12 +4184,14 @@ static void prvCheckTasksWaitingTermination( void )
 					if( eState == eSuspended )
 					{
 						vTaskSuspendAll();
+						taskENTER_CRITICAL_SMP();
 						{
 							if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
 							{
 								pxTaskStatus->eCurrentState = eBlocked;
 							}
 						}
+						taskEXIT_CRITICAL_SMP();
 						( void ) xTaskResumeAll();
 					}
 				}
@@ -3577,7 +4213,7 @@ static void prvCheckTasksWaitingTermination( void )
 			}
 			#else
 			{
-				pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( ( uint8_t * ) pxTCB->pxStack );
+				pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( ( uint8_t * ) pxTCB->pxStack + portSTACK_GUARD_SIZE );
 			}
 			#endif
 		}
@@ -3655,7 +4291,7 @@ static void prvCheckTasksWaitingTermination( void )
 
 		#if portSTACK_GROWTH < 0
 		{
-			pucEndOfStack = ( uint8_t * ) pxTCB->pxStack;
+			pucEndOfStack = ( uint8_t * ) pxTCB->pxStack + portSTACK_GUARD_SIZE;
 		}
 		#else
 		{
@@ -3751,21 +4387,35 @@ TCB_t *pxTCB;
 }
 /*-----------------------------------------------------------*/
 
-#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
+#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUMBER_OF_CORES > 1 ) )
 
 	TaskHandle_t xTaskGetCurrentTaskHandle( void )
 	{
 	TaskHandle_t xReturn;
 
-		/* A critical section is not required as this is not called from
-		an interrupt and the current TCB will always be the same for any
-		individual execution thread. */
-		xReturn = pxCurrentTCB;
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+		UBaseType_t uxSavedInterruptStatus;
+
+			/* The calling task must not move to another core between reading
+			the core ID and the entry of that core. */
+			uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK();
+			xReturn = pxCurrentTCBs[ portGET_CORE_ID() ];
+			portCLEAR_INTERRUPT_MASK( uxSavedInterruptStatus );
+		}
+		#else
+		{
+			/* A critical section is not required as this is not called from
+			an interrupt and the current TCB will always be the same for any
+			individual execution thread. */
+			xReturn = pxCurrentTCB;
+		}
+		#endif
 
 		return xReturn;
 	}
 
-#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) ) */
+#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUMBER_OF_CORES > 1 ) ) */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -3780,6 +4430,11 @@ TCB_t *pxTCB;
 		}
 		else
 		{
+			/* With more than one core the count of the calling core is read
+			in a critical section, so the task cannot move in between. */
+			#if ( configNUMBER_OF_CORES > 1 )
+				taskENTER_CRITICAL();
+			#endif
 			if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
 			{
 				xReturn = taskSCHEDULER_RUNNING;
@@ -3788,6 +4443,9 @@ TCB_t *pxTCB;
 			{
 				xReturn = taskSCHEDULER_SUSPENDED;
 			}
+			#if ( configNUMBER_OF_CORES > 1 )
+				taskEXIT_CRITICAL();
+			#endif
 		}
 
 		return xReturn;
@@ -4045,6 +4703,9 @@ TCB_t *pxTCB;
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
+
+					/* The mutex holder may be running on another core. */
+					taskYIELD_CORE_RUNNING_TASK( pxTCB );
 				}
 				else
 				{
@@ -4073,6 +4734,18 @@ TCB_t *pxTCB;
 
 		if( xSchedulerRunning != pdFALSE )
 		{
+			#if ( configNUMBER_OF_CORES > 1 )
+			{
+				/* The outermost critical section also keeps the other cores
+				out of the kernel. */
+				if( pxCurrentTCB->uxCriticalNesting == 0U )
+				{
+					portGET_TASK_LOCK();
+					portGET_ISR_LOCK();
+				}
+			}
+			#endif
+
 			( pxCurrentTCB->uxCriticalNesting )++;
 
 			/* This is not the interrupt safe version of the enter critical
@@ -4107,6 +4780,13 @@ TCB_t *pxTCB;
 
 				if( pxCurrentTCB->uxCriticalNesting == 0U )
 				{
+					#if ( configNUMBER_OF_CORES > 1 )
+					{
+						portRELEASE_ISR_LOCK();
+						portRELEASE_TASK_LOCK();
+					}
+					#endif
+
 					portENABLE_INTERRUPTS();
 				}
 				else
@@ -4154,6 +4834,39 @@ TCB_t *pxTCB;
 #endif /* ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) */
 /*-----------------------------------------------------------*/
 
+#if ( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+	static char *prvWriteCounterToBuffer( char *pcBuffer, const char *pcSeparator, configRUN_TIME_COUNTER_TYPE ulCounter )
+	{
+		/* Counters wider than int, such as the 64-bit counters of ports that
+		set configRUN_TIME_COUNTER_TYPE to uint64_t, must not be cut to 32 bits
+		by the casts below. */
+		if( sizeof( configRUN_TIME_COUNTER_TYPE ) > sizeof( unsigned int ) )
+		{
+			sprintf( pcBuffer, "%s%llu", pcSeparator, ( unsigned long long ) ulCounter );
+		}
+		else
+		{
+			#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
+			{
+				sprintf( pcBuffer, "%s%lu", pcSeparator, ( unsigned long ) ulCounter );
+			}
+			#else
+			{
+				/* sizeof( int ) == sizeof( long ) so a smaller
+				printf() library can be used. */
+				sprintf( pcBuffer, "%s%u", pcSeparator, ( unsigned int ) ulCounter );
+			}
+			#endif
+		}
+
+		/* Return the new end of string. */
+		return pcBuffer + strlen( pcBuffer );
+	}
+
+#endif /* ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 
 	void vTaskList( char * pcWriteBuffer )
@@ -4258,7 +4971,7 @@ TCB_t *pxTCB;
 	{
 	TaskStatus_t *pxTaskStatusArray;
 	volatile UBaseType_t uxArraySize, x;
-	uint32_t ulTotalTime, ulStatsAsPercentage;
+	configRUN_TIME_COUNTER_TYPE ulTotalTime, ulStatsAsPercentage;
 
 		#if( configUSE_TRACE_FACILITY != 1 )
 		{
@@ -4326,36 +5039,26 @@ TCB_t *pxTCB;
 					spaces so it can be printed in tabular form more
 					easily. */
 					pcWriteBuffer = prvWriteNameToBuffer( pcWriteBuffer, pxTaskStatusArray[ x ].pcTaskName );
+					pcWriteBuffer = prvWriteCounterToBuffer( pcWriteBuffer, "\t", pxTaskStatusArray[ x ].ulRunTimeCounter );
+
+					/* Ports that count instructions get a column for them
+					after the run time. */
+					#ifdef portGET_RUN_TIME_INSTRUCTION_COUNTER_VALUE
+					{
+						pcWriteBuffer = prvWriteCounterToBuffer( pcWriteBuffer, "\t", pxTaskStatusArray[ x ].ulRunTimeInstructionCounter );
+					}
+					#endif
 
 					if( ulStatsAsPercentage > 0UL )
 					{
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcWriteBuffer, "\t%lu\t\t%lu%%\r\n", pxTaskStatusArray[ x ].ulRunTimeCounter, ulStatsAsPercentage );
-						}
-						#else
-						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcWriteBuffer, "\t%u\t\t%u%%\r\n", ( unsigned int ) pxTaskStatusArray[ x ].ulRunTimeCounter, ( unsigned int ) ulStatsAsPercentage );
-						}
-						#endif
+						pcWriteBuffer = prvWriteCounterToBuffer( pcWriteBuffer, "\t\t", ulStatsAsPercentage );
+						strcpy( pcWriteBuffer, "%\r\n" );
 					}
 					else
 					{
 						/* If the percentage is zero here then the task has
 						consumed less than 1% of the total run time. */
-						#ifdef portLU_PRINTF_SPECIFIER_REQUIRED
-						{
-							sprintf( pcWriteBuffer, "\t%lu\t\t<1%%\r\n", pxTaskStatusArray[ x ].ulRunTimeCounter );
-						}
-						#else
-						{
-							/* sizeof( int ) == sizeof( long ) so a smaller
-							printf() library can be used. */
-							sprintf( pcWriteBuffer, "\t%u\t\t<1%%\r\n", ( unsigned int ) pxTaskStatusArray[ x ].ulRunTimeCounter );
-						}
-						#endif
+						strcpy( pcWriteBuffer, "\t\t<1%\r\n" );
 					}
 
 					pcWriteBuffer += strlen( pcWriteBuffer );
@@ -0,0 +1,235 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "workqueue.h"
+
+#if ( configUSE_TASK_NOTIFICATIONS == 0 ) && ( configUSE_WORK_QUEUES == 1 )
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to use the work queue
+#endif
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+to include work queue functionality. */
+#if ( configUSE_WORK_QUEUES == 1 )
+
+/* The pending items of a lane and the worker that runs them. */
+typedef struct xWORK_QUEUE_LANE
+{
+	WorkItem_t *pxHead;
+	WorkItem_t *pxTail;
+	TaskHandle_t xWorker;
+} WorkQueueLane_t;
+
+PRIVILEGED_DATA static WorkQueueLane_t xLanes[ configWORK_QUEUE_LANES ] = { { NULL, NULL, NULL } };
+
+/*
+ * The worker task of a lane, pvParameters points to the lane.
+ */
+static void prvWorkerTask( void *pvParameters ) PRIVILEGED_FUNCTION;
+
+/*
+ * Appends the item to its lane.  Called with interrupts masked, returns
+ * pdFALSE if the item was already pending.
+ */
+static BaseType_t prvEnqueue( WorkItem_t *pxItem ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkQueueCreateWorkers( void )
+{
+BaseType_t xReturn = pdPASS;
+UBaseType_t uxLane;
+char cName[ configMAX_TASK_NAME_LEN ];
+const char * const pcName = "WorkQ";
+UBaseType_t x;
+
+	/* The workers are called WorkQ0, WorkQ1, ... */
+	for( x = 0; ( x < ( UBaseType_t ) ( configMAX_TASK_NAME_LEN - 2 ) ) && ( pcName[ x ] != 0x00 ); x++ )
+	{
+		cName[ x ] = pcName[ x ];
+	}
+	cName[ x + 1 ] = 0x00;
+
+	for( uxLane = 0; ( uxLane < ( UBaseType_t ) configWORK_QUEUE_LANES ) && ( xReturn == pdPASS ); uxLane++ )
+	{
+		cName[ x ] = ( char ) ( '0' + uxLane );
+		xReturn = xTaskCreate( prvWorkerTask,
+							   cName,
+							   configWORK_QUEUE_TASK_STACK_DEPTH,
+							   ( void * ) &( xLanes[ uxLane ] ),
+							   ( ( UBaseType_t ) configWORK_QUEUE_TASK_PRIORITY - uxLane ) | portPRIVILEGE_BIT,
+							   &( xLanes[ uxLane ].xWorker ) );
+	}
+
+	configASSERT( xReturn );
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vWorkItemInit( WorkItem_t *pxItem, WorkFunction_t pxFunction, void *pvParameter, UBaseType_t uxLane )
+{
+	configASSERT( pxItem );
+	configASSERT( pxFunction );
+	configASSERT( uxLane < ( UBaseType_t ) configWORK_QUEUE_LANES );
+
+	pxItem->pxNext = NULL;
+	pxItem->pxFunction = pxFunction;
+	pxItem->pvParameter = pvParameter;
+	pxItem->uxLane = uxLane;
+	pxItem->xPending = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEnqueue( WorkItem_t *pxItem )
+{
+WorkQueueLane_t * const pxLane = &( xLanes[ pxItem->uxLane ] );
+BaseType_t xReturn;
+
+	if( pxItem->xPending == pdFALSE )
+	{
+		pxItem->xPending = pdTRUE;
+		pxItem->pxNext = NULL;
+
+		if( pxLane->pxTail == NULL )
+		{
+			pxLane->pxHead = pxItem;
+		}
+		else
+		{
+			pxLane->pxTail->pxNext = pxItem;
+		}
+		pxLane->pxTail = pxItem;
+
+		xReturn = pdPASS;
+	}
+	else
+	{
+		/* Coalesced with the submission that is still pending. */
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkQueueSubmit( WorkItem_t *pxItem )
+{
+BaseType_t xReturn;
+
+	configASSERT( pxItem );
+
+	taskENTER_CRITICAL();
+	{
+		xReturn = prvEnqueue( pxItem );
+	}
+	taskEXIT_CRITICAL();
+
+	/* Workers that do not exist yet run their lane when they start. */
+	if( ( xReturn != pdFALSE ) && ( xLanes[ pxItem->uxLane ].xWorker != NULL ) )
+	{
+		xTaskNotifyGive( xLanes[ pxItem->uxLane ].xWorker );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkQueueSubmitFromISR( WorkItem_t *pxItem, BaseType_t *pxHigherPriorityTaskWoken )
+{
+BaseType_t xReturn;
+UBaseType_t uxSavedInterruptStatus;
+
+	configASSERT( pxItem );
+
+	uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
+	{
+		xReturn = prvEnqueue( pxItem );
+	}
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+	if( ( xReturn != pdFALSE ) && ( xLanes[ pxItem->uxLane ].xWorker != NULL ) )
+	{
+		vTaskNotifyGiveFromISR( xLanes[ pxItem->uxLane ].xWorker, pxHigherPriorityTaskWoken );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void *pvParameters )
+{
+WorkQueueLane_t * const pxLane = ( WorkQueueLane_t * ) pvParameters;
+WorkItem_t *pxItem;
+
+	for( ;; )
+	{
+		/* Run the items of the lane until it is empty, then wait for the next
+		submission.  The notification count may be ahead of the items, which
+		only costs an extra pass through the loop. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				pxItem = pxLane->pxHead;
+
+				if( pxItem != NULL )
+				{
+					pxLane->pxHead = pxItem->pxNext;
+
+					if( pxLane->pxHead == NULL )
+					{
+						pxLane->pxTail = NULL;
+					}
+
+					/* From here on a new submission queues the item again. */
+					pxItem->xPending = pdFALSE;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( pxItem == NULL )
+			{
+				break;
+			}
+
+			pxItem->pxFunction( pxItem->pvParameter );
+		}
+
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_WORK_QUEUES == 1 */
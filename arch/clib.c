@@ -303,13 +303,44 @@ void exit(int code)
 }
 /*-----------------------------------------------------------*/
 
-/* formatted output conversion to frontend */
+/* Output buffer of one printf call. */
+typedef struct {
+	char buf[64];
+	int len;
+} PrintBuffer_t;
+
+static void prvPrintBufferFlush(PrintBuffer_t* pb)
+{
+	if (pb->len > 0) {
+		syscall(SYS_write, 1, (long) pb->buf, pb->len);
+		pb->len = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintBufferPutch(int ch, void** data)
+{
+	PrintBuffer_t* pb = (PrintBuffer_t*) data;
+
+	pb->buf[pb->len++] = ch;
+	if (ch == '\n' || pb->len == sizeof(pb->buf)) {
+		prvPrintBufferFlush(pb);
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* formatted output conversion to frontend.  The output is collected on the
+stack of the caller rather than in the buffer of putchar, so tasks can print
+at the same time and each line up to 64 characters is written in one piece. */
 int printf(const char* fmt, ...)
 {
 	va_list ap;
+	PrintBuffer_t pb;
 	va_start(ap, fmt);
 
-	vFormatPrintString((void*) putchar, 0, fmt, ap);
+	pb.len = 0;
+	vFormatPrintString(prvPrintBufferPutch, (void**) &pb, fmt, ap);
+	prvPrintBufferFlush(&pb);
 
 	va_end(ap);
 	return 0; // incorrect return value, but who cares, anyway?
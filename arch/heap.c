@@ -0,0 +1,19 @@
+#include "FreeRTOS.h"
+
+#include "heap.h"
+
+// Bounds of the free RAM, from link.ld.  The .heap section before them is
+// only there for malloc of newlib, see _sbrk in newlib.c.  It is empty unless
+// the Makefile defines _HEAP_SIZE.
+extern uint8_t _end[], _dmem_end[];
+
+void vHeapInit(void) {
+    HeapRegion_t regions[2];
+
+    regions[0].pucStartAddress = _end;
+    regions[0].xSizeInBytes = _dmem_end - _end;
+    regions[1].pucStartAddress = NULL;
+    regions[1].xSizeInBytes = 0;
+
+    vPortDefineHeapRegions(regions);
+}
@@ -0,0 +1,12 @@
+#ifndef __RISCV_HEAP_H__
+#define __RISCV_HEAP_H__
+
+// The demos link heap_5 and size it from the linker script instead of
+// configTOTAL_HEAP_SIZE.  vSyscallInit calls vHeapInit before main, so main
+// can create tasks and queues right away.
+
+// Hands the RAM that the program does not use to heap_5: everything in dmem
+// after the interrupt stack, see _dmem_end in link.ld.
+void vHeapInit(void);
+
+#endif
@@ -1,30 +1,371 @@
+#include <string.h>
+
 #include "FreeRTOS.h"
 #include "task.h"
 
 #include "irq.h"
+#include "encoding.h"
+#include "clib.h"
 
 
 static volatile uint32_t * const PLIC_CLAIM_AND_RESPONSE_REGISTER = (uint32_t * const)0x40200004; 
+static volatile uint32_t * const PLIC_THRESHOLD_REGISTER = (uint32_t * const)0x40200000;
+static volatile uint32_t * const PLIC_PRIORITY_REGISTERS = (uint32_t * const)0x40000000;
+static volatile uint32_t * const PLIC_PENDING_REGISTERS = (uint32_t * const)0x40001000;
+static volatile uint32_t * const PLIC_ENABLE_REGISTERS = (uint32_t * const)0x40002000;
+static BaseType_t irq_empty_handler(void *context) { (void)context; return pdFALSE; }
+
+typedef struct {
+	irq_handler_t handler;
+	void *context;
+	// odd while the handler updates the counters, see get_interrupt_counters
+	volatile uint32_t sequence;
+	irq_counters_t counters;
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	PortISRStats_t stats;
+#endif
+} irq_entry_t;
+
+static irq_entry_t irq_table[configIRQ_TABLE_SIZE] = { [ 0 ... configIRQ_TABLE_SIZE-1 ] = { .handler = irq_empty_handler } };
+
+// Per source state used by the trap entry in boot.S, which serves sources
+// bound with vIRQBindToTaskNotify and claims without a handler on its own.
+// boot.S indexes the table with the claimed source shifted by 5, so the
+// layout must not change.  irq_notify_any tells the software interrupt that
+// some source has pending notification bits.
+typedef struct {
+	uint32_t bits;               // 0 while the source is not bound
+	volatile uint32_t pending;   // bits posted since the last delivery
+	volatile uint32_t stamp;     // trap time of the first of them
+	uint32_t handled;            // a handler has been registered
+	volatile uint32_t spurious;  // claims without binding and handler
+	uint32_t reserved[3];
+} irq_trap_t;
+
+irq_trap_t irq_trap_table[configIRQ_TABLE_SIZE];
+volatile uint32_t irq_notify_any;
+const uint32_t irq_table_size = configIRQ_TABLE_SIZE;
+static TaskHandle_t irq_notify_tasks[configIRQ_TABLE_SIZE];
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+typedef struct {
+	PortLatencyStats_t dispatch;
+	PortLatencyStats_t wake;
+} irq_latency_t;
+
+static irq_latency_t irq_latency[configIRQ_TABLE_SIZE];
+
+// The source that pended the next context switch of a hart and its trap
+// time, see vIRQLatencyTaskSwitched.  The first one wins if several do.
+static uint32_t wake_irq[configNUMBER_OF_CORES];
+static unsigned long wake_stamp[configNUMBER_OF_CORES];
+
+static inline void wake_pending(uint32_t irq_id, unsigned long stamp) {
+	const BaseType_t core = portGET_CORE_ID();
+	if (wake_irq[core] == 0) {
+		wake_irq[core] = irq_id;
+		wake_stamp[core] = stamp;
+	}
+}
+#endif
+
+// Called by boot.S with the claimed source and, with
+// configUSE_IRQ_LATENCY_STATS, the mcycle value read at the trap entry.
+void vExternalInterruptHandler(uint32_t irq_id, unsigned long entry_cycle);
+
+// The counters are only written by the handler of their source, which cannot
+// preempt itself, so a sequence count is enough to give readers a consistent
+// copy without masking interrupts.
+static inline void counters_begin(irq_entry_t *entry) {
+	entry->sequence++;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void counters_end(irq_entry_t *entry) {
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	entry->sequence++;
+}
+
+/*
+ * Runs the handler of a claimed source with interrupts enabled and the PLIC
+ * threshold raised to the priority of the source, so only sources with a
+ * higher priority can preempt it.  mepc and mstatus are kept here because a
+ * nested trap overwrites them.  The tick and software interrupts stay masked
+ * while nested, they must only be taken on the way back to a task.  A context
+ * switch requested by the handler is pended on the software interrupt, so it
+ * happens once after the outermost handler has returned.
+ */
+static void run_handler(uint32_t irq_id, unsigned long entry_cycle) {
+	irq_entry_t *entry = &irq_table[irq_id];
+	uint32_t threshold = *PLIC_THRESHOLD_REGISTER;
+	unsigned long epc = read_csr(mepc);
+	unsigned long status = read_csr(mstatus);
+	unsigned long masked = clear_csr(mie, MIP_MTIP | MIP_MSIP) & (MIP_MTIP | MIP_MSIP);
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	PortISRSample_t sample;
+	vPortISRStatsEnter(&sample);
+#endif
+
+	*PLIC_THRESHOLD_REGISTER = PLIC_PRIORITY_REGISTERS[irq_id];
+	set_csr(mstatus, MSTATUS_MIE);
+
+	unsigned long start = read_csr(mcycle);
+	BaseType_t ans = entry->handler(entry->context);
+	uint32_t cycles = (uint32_t)(read_csr(mcycle) - start);
+
+	clear_csr(mstatus, MSTATUS_MIE);
+
+	counters_begin(entry);
+	entry->counters.count++;
+	entry->counters.total_cycles += cycles;
+	if (cycles > entry->counters.max_cycles)
+		entry->counters.max_cycles = cycles;
+	counters_end(entry);
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	vPortISRStatsExit(&sample, &entry->stats);
+#endif
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+	vPortLatencyRecord(&irq_latency[irq_id].dispatch, (uint32_t)(start - entry_cycle));
+	if (ans != pdFALSE)
+		wake_pending(irq_id, entry_cycle);
+#else
+	(void)entry_cycle;
+#endif
+
+	write_csr(mepc, epc);
+	write_csr(mstatus, status);
+	set_csr(mie, masked);
+	*PLIC_THRESHOLD_REGISTER = threshold;
+
+	if (ans != pdFALSE)
+		vPortPendYield();
+}
+
+// The same as boot.S does for a bound source.  The A extension is required
+// with several harts, without it nothing else runs while interrupts are
+// disabled.
+static void post_notification(irq_trap_t *trap, unsigned long entry_cycle) {
+#ifdef __riscv_atomic
+	uint32_t before = __atomic_fetch_or(&trap->pending, trap->bits, __ATOMIC_RELAXED);
+#else
+	uint32_t before = trap->pending;
+	trap->pending = before | trap->bits;
+#endif
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+	if (before == 0)
+		trap->stamp = (uint32_t)entry_cycle;
+#else
+	(void)before;
+	(void)entry_cycle;
+#endif
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	irq_notify_any = 1;
+	vPortPendYield();
+}
+
+static void count_spurious(irq_trap_t *trap) {
+#ifdef __riscv_atomic
+	__atomic_fetch_add(&trap->spurious, 1, __ATOMIC_RELAXED);
+#else
+	trap->spurious++;
+#endif
+}
+
+// A claim hands out the highest priority pending source even if it is at or
+// below the threshold, so the PLIC is only claimed again while a source above
+// the threshold the trap was taken with is pending.  The others stay pending
+// and raise the interrupt again once the threshold drops.  boot.S does the
+// same before it claims again.
+static int pending_above(uint32_t threshold) {
+	for (uint32_t base = 0; base < configIRQ_TABLE_SIZE; base += 32) {
+		uint32_t bits = PLIC_PENDING_REGISTERS[base / 32] & PLIC_ENABLE_REGISTERS[base / 32];
 
-static BaseType_t irq_empty_handler() { return pdFALSE; }
+		for (uint32_t irq_id = base; bits != 0; irq_id++, bits >>= 1)
+			if ((bits & 1) && PLIC_PRIORITY_REGISTERS[irq_id] > threshold)
+				return 1;
+	}
+	return 0;
+}
+
+/*
+ * boot.S serves claims on its own until it meets a source with a handler.
+ * It then saves the caller saved registers and calls this function, which
+ * serves that source and keeps claiming while a source above the threshold is
+ * pending, so a burst costs a single trap.  Claims that return no source or
+ * one beyond the table are counted as spurious on source 0.
+ */
+void vExternalInterruptHandler(uint32_t irq_id, unsigned long entry_cycle) {
+	// run_handler restores the threshold before it returns
+	const uint32_t threshold = *PLIC_THRESHOLD_REGISTER;
+
+	do {
+		irq_trap_t *trap = &irq_trap_table[irq_id < configIRQ_TABLE_SIZE ? irq_id : 0];
+
+		if (trap->bits != 0)
+			post_notification(trap, entry_cycle);
+		else if (trap->handled)
+			run_handler(irq_id, entry_cycle);
+		else
+			count_spurious(trap);
 
-#define IRQ_TABLE_NUM_ENTRIES 64
+		*PLIC_CLAIM_AND_RESPONSE_REGISTER = irq_id;
+		if (!pending_above(threshold))
+			break;
+		irq_id = *PLIC_CLAIM_AND_RESPONSE_REGISTER;
+	} while (irq_id != 0);
+}
+
+void register_interrupt_handler(uint32_t irq_id, irq_handler_t fn, void *context, uint32_t priority) {
+	configASSERT (irq_id > 0 && irq_id < configIRQ_TABLE_SIZE);
+	configASSERT (fn != NULL);
 
-static irq_handler_t irq_handler_table[IRQ_TABLE_NUM_ENTRIES] = { [ 0 ... IRQ_TABLE_NUM_ENTRIES-1 ] = irq_empty_handler };
+	// the source stays disabled until handler and context match
+	PLIC_PRIORITY_REGISTERS[irq_id] = 0;
+	irq_table[irq_id].context = context;
+	irq_table[irq_id].handler = fn;
+	irq_trap_table[irq_id].handled = 1;
+	PLIC_PRIORITY_REGISTERS[irq_id] = priority;
+}
 
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+void vIRQBindToTaskNotify(uint32_t irq_id, TaskHandle_t task, uint32_t bits) {
+	configASSERT (irq_id > 0 && irq_id < configIRQ_TABLE_SIZE);
+	uint32_t priority = PLIC_PRIORITY_REGISTERS[irq_id];
 
-BaseType_t xExternalInterruptHandler() {
-	uint32_t irq_id = *PLIC_CLAIM_AND_RESPONSE_REGISTER;
+	if (task == NULL)
+		bits = 0;
 
-	BaseType_t ans = irq_handler_table[irq_id]();
+	// the source stays disabled until bits and task match
+	PLIC_PRIORITY_REGISTERS[irq_id] = 0;
+	irq_trap_table[irq_id].bits = bits;
+	irq_notify_tasks[irq_id] = task;
+	PLIC_PRIORITY_REGISTERS[irq_id] = priority;
+}
+#endif
 
-	*PLIC_CLAIM_AND_RESPONSE_REGISTER = 1;
-	
+// The bits are taken with an atomic swap, boot.S may post new ones on another
+// hart meanwhile.  Without the A extension there is a single hart and the
+// software interrupt runs with interrupts disabled, so a plain read and clear
+// is enough.
+static inline uint32_t take_bits(volatile uint32_t *bits) {
+#ifdef __riscv_atomic
+	return __atomic_exchange_n(bits, 0, __ATOMIC_ACQUIRE);
+#else
+	uint32_t ans = *bits;
+	*bits = 0;
 	return ans;
+#endif
 }
 
-void register_interrupt_handler(uint32_t irq_id, irq_handler_t fn) {
-	configASSERT (irq_id < IRQ_TABLE_NUM_ENTRIES);
-	irq_handler_table[irq_id] = fn;
+void vIRQDeliverTaskNotifications(void) {
+	if (take_bits(&irq_notify_any) == 0)
+		return;
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+	for (uint32_t irq_id = 1; irq_id < configIRQ_TABLE_SIZE; irq_id++) {
+		uint32_t bits = take_bits(&irq_trap_table[irq_id].pending);
+		TaskHandle_t task = irq_notify_tasks[irq_id];
+
+		// the caller switches tasks next anyway, so nobody needs to know
+		// whether a task of higher priority was woken
+		if (bits != 0 && task != NULL) {
+			xTaskNotifyFromISR(task, bits, eSetBits, NULL);
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+			wake_pending(irq_id, irq_trap_table[irq_id].stamp);
+#endif
+		}
+	}
+#endif
+}
+
+void set_interrupt_priority(uint32_t irq_id, uint32_t priority) {
+	configASSERT (irq_id < configIRQ_TABLE_SIZE);
+	PLIC_PRIORITY_REGISTERS[irq_id] = priority;
+}
+
+void get_interrupt_counters(uint32_t irq_id, irq_counters_t *counters) {
+	configASSERT (irq_id < configIRQ_TABLE_SIZE);
+	const irq_entry_t *entry = &irq_table[irq_id];
+	uint32_t sequence;
+
+	do {
+		sequence = entry->sequence;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		*counters = entry->counters;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((sequence & 1) != 0 || sequence != entry->sequence);
+
+	counters->spurious = irq_trap_table[irq_id].spurious;
 }
 
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+void get_interrupt_stats(uint32_t irq_id, PortISRStats_t *stats) {
+	configASSERT (irq_id < configIRQ_TABLE_SIZE);
+	unsigned long status = clear_csr(mstatus, MSTATUS_MIE);
+	*stats = irq_table[irq_id].stats;
+	set_csr(mstatus, status & MSTATUS_MIE);
+}
+#endif
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+void vIRQLatencyTaskSwitched(void) {
+	const BaseType_t core = portGET_CORE_ID();
+
+	if (wake_irq[core] != 0) {
+		uint32_t cycles = (uint32_t)(read_csr(mcycle) - wake_stamp[core]);
+		vPortLatencyRecord(&irq_latency[wake_irq[core]].wake, cycles);
+		wake_irq[core] = 0;
+	}
+}
+
+void get_interrupt_latency(uint32_t irq_id, PortLatencyStats_t *dispatch, PortLatencyStats_t *wake) {
+	configASSERT (irq_id < configIRQ_TABLE_SIZE);
+	unsigned long status = clear_csr(mstatus, MSTATUS_MIE);
+	*dispatch = irq_latency[irq_id].dispatch;
+	*wake = irq_latency[irq_id].wake;
+	set_csr(mstatus, status & MSTATUS_MIE);
+}
+
+void reset_interrupt_latency(void) {
+	unsigned long status = clear_csr(mstatus, MSTATUS_MIE);
+	memset(irq_latency, 0, sizeof(irq_latency));
+	set_csr(mstatus, status & MSTATUS_MIE);
+	vPortResetTickLatencyStats();
+}
+
+static void print_latency(const char *name, const PortLatencyStats_t *stats) {
+	if (stats->ulCount == 0)
+		return;
+
+	printf("%-16s %lu samples, min %lu avg %lu max %lu cycles\n", name,
+	       (unsigned long)stats->ulCount, (unsigned long)stats->ulMin,
+	       (unsigned long)(stats->ullTotal / stats->ulCount), (unsigned long)stats->ulMax);
+	for (int i = 0; i < portLATENCY_BUCKETS; ++i) {
+		if (stats->ulHistogram[i] == 0)
+			continue;
+		if (i == portLATENCY_BUCKETS - 1)
+			printf("    >= %8lu %10lu\n", 1UL << i, (unsigned long)stats->ulHistogram[i]);
+		else
+			printf("    <  %8lu %10lu\n", 2UL << i, (unsigned long)stats->ulHistogram[i]);
+	}
+}
+
+void print_interrupt_latency(void) {
+	PortLatencyStats_t dispatch, wake;
+	char name[24];
+
+	vPortGetTickLatencyStats(&dispatch);
+	print_latency("tick", &dispatch);
+
+	for (uint32_t irq_id = 1; irq_id < configIRQ_TABLE_SIZE; irq_id++) {
+		get_interrupt_latency(irq_id, &dispatch, &wake);
+		sprintf(name, "irq %u dispatch", (unsigned)irq_id);
+		print_latency(name, &dispatch);
+		sprintf(name, "irq %u wake", (unsigned)irq_id);
+		print_latency(name, &wake);
+	}
+}
+#endif
@@ -3,10 +3,86 @@
 
 #include "stdint.h"
 
-typedef BaseType_t (*irq_handler_t)(void);
+// Number of PLIC sources with an entry in the handler table.  Set it in
+// FreeRTOSConfig.h to the number of sources of the platform.
+#ifndef configIRQ_TABLE_SIZE
+#define configIRQ_TABLE_SIZE 64
+#endif
+
+// The handler gets the context pointer it was registered with, so a driver
+// can keep its state in its own structure rather than in globals.
+typedef BaseType_t (*irq_handler_t)(void *context);
+
+// Installs the handler of a source and sets its PLIC priority.  Priority 0
+// leaves the source disabled, e.g. until set_interrupt_priority is called.
+void register_interrupt_handler(uint32_t irq_id, irq_handler_t fn, void *context, uint32_t priority);
+
+// Sources with a priority above configMAX_SYSCALL_INTERRUPT_PRIORITY are not
+// masked by kernel critical sections, but their handlers must not call the
+// FreeRTOS API.  A handler can be preempted by sources with a higher priority.
+void set_interrupt_priority(uint32_t irq_id, uint32_t priority);
+
+typedef struct {
+    uint32_t count;         // runs of the handler
+    uint32_t spurious;      // claims without a handler or binding
+    uint64_t total_cycles;  // cycles in the handler, nested handlers included
+    uint32_t max_cycles;    // longest single run
+} irq_counters_t;
+
+// Copies the counters of a source.  Claims that return no source or one
+// beyond the table are counted as spurious on source 0.  Must be called from
+// a task, it does not disable interrupts but retries if the handler updated
+// the counters meanwhile.
+void get_interrupt_counters(uint32_t irq_id, irq_counters_t *counters);
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+// Binds a source to notification bits of a task, for devices whose handler
+// would only wake a task.  The trap entry in boot.S claims the source, adds
+// the bits to the pending bits of the source and completes the claim without
+// saving the caller saved registers or calling a handler.  The bits are sent
+// to the task with eSetBits by the software interrupt, right before it picks
+// the next task, so a woken task of higher priority runs when the trap returns.
+// The source keeps its priority, set it with set_interrupt_priority.  A bound
+// source takes precedence over a registered handler and is not counted in the
+// counters of the source.  Bits 0 or task NULL remove the binding again.
+void vIRQBindToTaskNotify(uint32_t irq_id, TaskHandle_t task, uint32_t bits);
+#endif
 
-void register_interrupt_handler(uint32_t irq_id, irq_handler_t fn);
+// Sends the pending bits of the bound sources, called by the software
+// interrupt in portasm.S.
+void vIRQDeliverTaskNotifications(void);
+
+#if( configUSE_IRQ_LATENCY_STATS == 1 )
+// Latency of a source in cycles, measured from the mcycle value read at the
+// trap entry in boot.S.  dispatch ends when the handler is called, wake when
+// the context switch requested by the handler or by a bound notification has
+// selected the next task, right before its registers are restored.  Sources
+// bound with vIRQBindToTaskNotify only have wake latencies, from the first
+// trap since their bits were last delivered.
+void get_interrupt_latency(uint32_t irq_id, PortLatencyStats_t *dispatch, PortLatencyStats_t *wake);
+
+// Clears the latencies of all sources and of the tick.
+void reset_interrupt_latency(void);
+
+// Prints the latencies of the tick and of every source that has any, with
+// their histograms.  Must be called from a task.
+void print_interrupt_latency(void);
+
+// Records the wake latency once the software interrupt has switched tasks,
+// called by portasm.S.
+void vIRQLatencyTaskSwitched(void);
+#endif
+
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+// Copies the cycles and instructions spent in the handler of a source and the
+// number of times it ran.  Time in higher priority handlers that preempted it
+// is included.
+void get_interrupt_stats(uint32_t irq_id, PortISRStats_t *stats);
+#endif
 
+// A handler returns pdTRUE to request a context switch.  The switch is pended
+// and performed once all running interrupt handlers have finished.
 #define portYIELD_FROM_ISR( xHigherPriorityTaskWoken )      \
     if ( (xHigherPriorityTaskWoken) == pdTRUE ) {           \
         return pdTRUE;                                      \
@@ -0,0 +1,22 @@
+#ifndef __RISCV_MEMOPS_H__
+#define __RISCV_MEMOPS_H__
+
+#include "stddef.h"
+#include "stdint.h"
+
+// memops.c also replaces memcpy, memset and memcmp of the C library, so the
+// kernel queues, the FAT cache and the network buffers use them without any
+// change.  Built for a target with the V extension they run strip mined
+// vector loops from tasks, and scalar code from interrupt handlers and for
+// short blocks.  Without the V extension only the scalar code is built.
+
+// Internet checksum (RFC 1071) of len bytes, inverted and ready to be stored
+// as is in an IP, UDP or ICMP header.
+uint16_t ip_checksum(const void *data, size_t len);
+
+// CRC-32 as used by Ethernet, zlib and the GPT headers read by FreeRTOS+FAT.
+// Pass 0 for the first block and the previous result to continue with the
+// next one.
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#endif
@@ -0,0 +1,241 @@
+#include <stddef.h>
+#include <errno.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+// Runtime layer for the newlib C library linked with -lc.
+//
+// With configUSE_NEWLIB_REENTRANT set to 1 in FreeRTOSConfig.h every task has
+// its own struct _reent, and the kernel points _impure_ptr at it on each
+// context switch.  errno, the strtok state and the stdio buffers are then per
+// task.  The locks below protect what is still shared: the malloc arena, the
+// environment, the list of open streams and the atexit handlers.
+//
+// newlib built with --enable-newlib-retargetable-locking calls the
+// __retarget_lock functions directly.  Without it, only __malloc_lock and
+// __env_lock are hooks, so they are defined here as well.  Every lock is a
+// recursive kernel mutex: a task that waits for one blocks, while the
+// scheduler and the interrupts keep running.
+//
+// Before the scheduler starts, while it is suspended and inside interrupt
+// handlers the locks do nothing, as only one context can run there.  Handlers
+// must still not call malloc or stdio, because they could find the data
+// structures half updated by the task they interrupted.  A lock that another
+// task holds there fails configASSERT instead of being skipped.  The task holding a
+// mutex records for each of its acquires whether it took the mutex, so the
+// matching release gives it back only then, even if the scheduler was
+// suspended or resumed in between.
+
+#if ( configUSE_RECURSIVE_MUTEXES != 1 )
+#error newlib.c needs configUSE_RECURSIVE_MUTEXES set to 1
+#endif
+
+struct __lock {
+    SemaphoreHandle_t mutex;
+    TaskHandle_t owner;     // task holding the mutex, only written by it
+    uint32_t taken;         // a bit per acquire of the owner, set if it took the mutex
+    uint32_t depth;         // acquires of the owner not released yet
+};
+
+// The static locks of newlib, created on first use.
+struct __lock __lock___sinit_recursive_mutex;
+struct __lock __lock___sfp_recursive_mutex;
+struct __lock __lock___atexit_recursive_mutex;
+struct __lock __lock___at_quick_exit_mutex;
+struct __lock __lock___malloc_recursive_mutex;
+struct __lock __lock___env_recursive_mutex;
+struct __lock __lock___tz_mutex;
+struct __lock __lock___dd_hash_mutex;
+struct __lock __lock___arc4random_mutex;
+
+void __retarget_lock_init(struct __lock **lock);
+void __retarget_lock_init_recursive(struct __lock **lock);
+void __retarget_lock_close(struct __lock *lock);
+void __retarget_lock_close_recursive(struct __lock *lock);
+void __retarget_lock_acquire(struct __lock *lock);
+void __retarget_lock_acquire_recursive(struct __lock *lock);
+int __retarget_lock_try_acquire(struct __lock *lock);
+int __retarget_lock_try_acquire_recursive(struct __lock *lock);
+void __retarget_lock_release(struct __lock *lock);
+void __retarget_lock_release_recursive(struct __lock *lock);
+
+struct _reent;
+void __malloc_lock(struct _reent *r);
+void __malloc_unlock(struct _reent *r);
+void __env_lock(struct _reent *r);
+void __env_unlock(struct _reent *r);
+void *_sbrk(ptrdiff_t incr);
+
+// The interrupt check comes first, xTaskGetSchedulerState enters a critical
+// section in SMP, which must not happen inside a handler.
+static int locks_needed(void) {
+    return !portIS_INSIDE_INTERRUPT() &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// A handler may interrupt the owner, so it must not use the record.
+static int is_owner(struct __lock *lock) {
+    return !portIS_INSIDE_INTERRUPT() && lock->owner != NULL &&
+           lock->owner == xTaskGetCurrentTaskHandle();
+}
+
+static void push_acquire(struct __lock *lock, uint32_t taken) {
+    configASSERT(lock->depth < 32);
+    lock->taken = (lock->taken << 1) | taken;
+    lock->depth++;
+}
+
+static void took_mutex(struct __lock *lock) {
+    lock->owner = xTaskGetCurrentTaskHandle();
+    push_acquire(lock, 1);
+}
+
+// Called where the lock cannot be taken.  The data it protects may be half
+// updated by another task that holds it, so that must not happen.
+static void skip_acquire(struct __lock *lock) {
+    configASSERT(lock->owner == NULL || is_owner(lock));
+    if (is_owner(lock))
+        push_acquire(lock, 0);
+}
+
+// Two tasks may race to create the mutex of a static lock.  The loser deletes
+// its mutex again, so the creation itself stays out of the critical section.
+static SemaphoreHandle_t get_mutex(struct __lock *lock) {
+    SemaphoreHandle_t mutex = lock->mutex;
+
+    if (mutex == NULL) {
+        mutex = xSemaphoreCreateRecursiveMutex();
+        configASSERT(mutex != NULL);
+
+        taskENTER_CRITICAL();
+        if (lock->mutex == NULL) {
+            lock->mutex = mutex;
+            mutex = NULL;
+        }
+        taskEXIT_CRITICAL();
+
+        if (mutex != NULL)
+            vSemaphoreDelete(mutex);
+        mutex = lock->mutex;
+    }
+
+    return mutex;
+}
+
+void __retarget_lock_init(struct __lock **lock) {
+    __retarget_lock_init_recursive(lock);
+}
+
+void __retarget_lock_init_recursive(struct __lock **lock) {
+    struct __lock *l = pvPortMalloc(sizeof(*l));
+
+    configASSERT(l != NULL);
+    l->mutex = NULL;
+    l->owner = NULL;
+    l->taken = 0;
+    l->depth = 0;
+    *lock = l;
+}
+
+void __retarget_lock_close(struct __lock *lock) {
+    __retarget_lock_close_recursive(lock);
+}
+
+void __retarget_lock_close_recursive(struct __lock *lock) {
+    if (lock == NULL)
+        return;
+    if (lock->mutex != NULL)
+        vSemaphoreDelete(lock->mutex);
+    vPortFree(lock);
+}
+
+void __retarget_lock_acquire(struct __lock *lock) {
+    __retarget_lock_acquire_recursive(lock);
+}
+
+void __retarget_lock_acquire_recursive(struct __lock *lock) {
+    if (lock == NULL)
+        return;
+    if (locks_needed()) {
+        xSemaphoreTakeRecursive(get_mutex(lock), portMAX_DELAY);
+        took_mutex(lock);
+    } else {
+        skip_acquire(lock);
+    }
+}
+
+int __retarget_lock_try_acquire(struct __lock *lock) {
+    return __retarget_lock_try_acquire_recursive(lock);
+}
+
+int __retarget_lock_try_acquire_recursive(struct __lock *lock) {
+    if (lock == NULL)
+        return 1;
+    if (!locks_needed()) {
+        skip_acquire(lock);
+        return 1;
+    }
+    if (xSemaphoreTakeRecursive(get_mutex(lock), 0) != pdTRUE)
+        return 0;
+    took_mutex(lock);
+    return 1;
+}
+
+void __retarget_lock_release(struct __lock *lock) {
+    __retarget_lock_release_recursive(lock);
+}
+
+// Only the owner took the mutex, any other caller did not.  The owner is
+// cleared before the last give, after which the next task may set it.
+void __retarget_lock_release_recursive(struct __lock *lock) {
+    uint32_t taken;
+
+    if (lock == NULL || !is_owner(lock))
+        return;
+
+    taken = lock->taken & 1;
+    lock->taken >>= 1;
+    if (--lock->depth == 0)
+        lock->owner = NULL;
+    if (taken)
+        xSemaphoreGiveRecursive(lock->mutex);
+}
+
+void __malloc_lock(struct _reent *r) {
+    ( void ) r;
+    __retarget_lock_acquire_recursive(&__lock___malloc_recursive_mutex);
+}
+
+void __malloc_unlock(struct _reent *r) {
+    ( void ) r;
+    __retarget_lock_release_recursive(&__lock___malloc_recursive_mutex);
+}
+
+void __env_lock(struct _reent *r) {
+    ( void ) r;
+    __retarget_lock_acquire_recursive(&__lock___env_recursive_mutex);
+}
+
+void __env_unlock(struct _reent *r) {
+    ( void ) r;
+    __retarget_lock_release_recursive(&__lock___env_recursive_mutex);
+}
+
+// Grows the malloc arena of newlib inside the .heap section of link.ld.  The
+// kernel allocates from its own heap with pvPortMalloc.  malloc holds the
+// malloc lock while it calls here.
+void *_sbrk(ptrdiff_t incr) {
+    extern char _heap_start[], _heap_end[];
+    static char *heap_top = _heap_start;
+    char *prev = heap_top;
+
+    if (incr > _heap_end - heap_top || incr < _heap_start - heap_top) {
+        errno = ENOMEM;
+        return (void *)-1;
+    }
+
+    heap_top += incr;
+    return prev;
+}
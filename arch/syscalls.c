@@ -75,6 +75,7 @@
 #include "syscalls.h"
 #include "encoding.h"
 #include "clib.h"
+#include "heap.h"
 
 volatile uint64_t tohost __attribute__((aligned(64)));
 volatile uint64_t fromhost __attribute__((aligned(64)));
@@ -144,10 +145,41 @@ int __attribute__((weak)) main(__attribute__ ((unused)) int argc, __attribute__
 }
 /*-----------------------------------------------------------*/
 
+/* Records the end of a boot phase.  boot.S and xPortStartScheduler stamp
+ulBootCycles directly where a call would be in the way. */
+unsigned long ulBootCycles[BOOT_PHASES];
+
+void vSyscallBootPhase(unsigned long phase)
+{
+	ulBootCycles[phase] = read_csr(mcycle);
+}
+/*-----------------------------------------------------------*/
+
+/* Prints the boot phases with configUSE_BOOT_PROFILE set to 1.  Called by the
+application once the first task runs, printing earlier would add to the
+phases it reports. */
+void vSyscallBootReport(void)
+{
+	#if configUSE_BOOT_PROFILE == 1
+	static const char * const names[BOOT_PHASES] = {
+		"sections", "main", "scheduler", "first task"
+	};
+	unsigned long i;
+
+	for (i = 0; i < BOOT_PHASES; i++) {
+		printf("boot: %-10s %10lu cycles (+%lu)\n", names[i], ulBootCycles[i],
+		       ulBootCycles[i] - (i > 0 ? ulBootCycles[i - 1] : 0));
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
 /* Starts main function. */
 void vSyscallInit(void)
 {
 	__asm volatile("csrs mie,%0"::"r"(0x800));  // enable external interrupts
+	vHeapInit();
+	vSyscallBootPhase(BOOT_PHASE_MAIN);
 	int ret = main(0, 0);
 	exit(ret);
 }
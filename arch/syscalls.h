@@ -73,13 +73,47 @@
 #ifndef SYSCALLS_H
 #define SYSCALLS_H
 
+/* For configUSE_BOOT_PROFILE and configPAINT_BOOT_STACK, boot.S includes this
+file as well. */
+#include "FreeRTOSConfig.h"
+
 #define SYS_write 64
 #define SYS_exit 93
 #define SYS_timer 1234
 
+/* Boot phases, timestamped with mcycle by boot.S, vSyscallInit and
+xPortStartScheduler.  mcycle starts at zero on reset, so every stamp is the
+number of cycles since reset. */
+#define BOOT_PHASE_SECTIONS		0	/* .bss and .sbss cleared, .tdata copied */
+#define BOOT_PHASE_MAIN			1	/* main() called */
+#define BOOT_PHASE_SCHEDULER	2	/* xPortStartScheduler entered */
+#define BOOT_PHASE_FIRST_TASK	3	/* first task restored */
+#define BOOT_PHASES				4
+
+/* Set to 1 to have vSyscallBootReport print the boot phases.  All of them are
+stamped once the first task runs, so that task can call it. */
+#ifndef configUSE_BOOT_PROFILE
+	#define configUSE_BOOT_PROFILE 0
+#endif
+
+/* Set to 1 to fill the boot stack with 0xAB in boot.S, which shows how deep
+main went but costs a store for every word of _STACK_SIZE. */
+#ifndef configPAINT_BOOT_STACK
+	#define configPAINT_BOOT_STACK 0
+#endif
+
+#ifndef __ASSEMBLER__
+
 long syscall(long num, long arg0, long arg1, long arg2);
 
 void vSyscallInit(void);
 unsigned long ulSyscallTrap(long cause, long epc, long regs[32]);
 
+/* Stamps of the boot phases, see BOOT_PHASE_SECTIONS. */
+extern unsigned long ulBootCycles[BOOT_PHASES];
+void vSyscallBootPhase(unsigned long phase);
+void vSyscallBootReport(void);
+
+#endif /* __ASSEMBLER__ */
+
 #endif /* SYSCALLS_H */